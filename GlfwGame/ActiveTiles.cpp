@@ -0,0 +1,130 @@
+#include "ActiveTiles.h"
+#include "LifeGrid.h"
+#include "LifeKernel.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+constexpr uint8_t ActiveTiles::MARKED; // fill and assign take it by reference
+
+ActiveTiles::ActiveTiles(const LifeGrid& grid)
+    : m_words_per_row(grid.words_per_row())
+{
+    m_tiles_x = (m_words_per_row + TILE_WORDS - 1) / TILE_WORDS;
+    m_tiles_y = (grid.height() + TILE_ROWS - 1) / TILE_ROWS;
+
+    m_changed.assign(tile_count(), MARKED);
+    m_next_changed.assign(tile_count(), 0);
+    m_tile_stats[0].resize(tile_count());
+    m_tile_stats[1].resize(tile_count());
+    m_row_stats.resize(m_tiles_y);
+    m_row_hash_change.resize(m_tiles_y);
+}
+
+void ActiveTiles::mark_all()
+{
+    std::fill(m_changed.begin(), m_changed.end(), MARKED);
+}
+
+void ActiveTiles::mark_cell(int x, int y)
+{
+    m_changed[(y / TILE_ROWS) * m_tiles_x + (x >> 6) / TILE_WORDS] = MARKED;
+}
+
+void ActiveTiles::step(const LifeGrid& src, LifeGrid& dst, const Rule& rule, ThreadPool& pool)
+{
+    std::atomic<int> active{ 0 };
+    m_stats_side = 1 - m_stats_side;
+    std::vector<LifeStats>& dst_stats = m_tile_stats[m_stats_side];
+    const std::vector<LifeStats>& src_stats = m_tile_stats[1 - m_stats_side];
+
+    // one task per row of tiles, every tile is written by one task only
+    pool.run(m_tiles_y, [&](int ty) {
+        int row_active = 0;
+        LifeStats row_stats;
+        uint64_t row_hash_change = 0;
+        for (int tx = 0; tx < m_tiles_x; ++tx) {
+            const int tile = ty * m_tiles_x + tx;
+            bool changed = false;
+            if (needs_step(tx, ty)) {
+                dst_stats[tile] = LifeStats();
+                changed = step_tile(src, dst, rule, tx, ty, dst_stats[tile], row_hash_change);
+                ++row_active;
+            }
+            else {
+                dst_stats[tile].births = src_stats[tile].births + dst_stats[tile].population - src_stats[tile].population;
+            }
+            row_stats.add(dst_stats[tile]);
+            // a marked tile is also stepped next time, to overwrite the other buffer too
+            m_next_changed[tile] = changed || m_changed[tile] == MARKED;
+        }
+        m_row_stats[ty] = row_stats;
+        m_row_hash_change[ty] = row_hash_change;
+        active += row_active;
+    });
+
+    m_changed.swap(m_next_changed);
+    m_active_count = active;
+    m_stats = LifeStats();
+    m_hash_change = 0;
+    for (int ty = 0; ty < m_tiles_y; ++ty) {
+        m_stats.add(m_row_stats[ty]);
+        m_hash_change ^= m_row_hash_change[ty];
+    }
+}
+
+bool ActiveTiles::needs_step(int tx, int ty) const
+{
+    for (int dy = -1; dy <= 1; ++dy) {
+        int y = ty + dy;
+        if (y < 0 || y >= m_tiles_y) {
+            if (!m_wrap) continue;
+            y = (y + m_tiles_y) % m_tiles_y;
+        }
+        for (int dx = -1; dx <= 1; ++dx) {
+            int x = tx + dx;
+            if (x < 0 || x >= m_tiles_x) {
+                if (!m_wrap) continue;
+                x = (x + m_tiles_x) % m_tiles_x;
+            }
+            if (m_changed[y * m_tiles_x + x]) return true;
+        }
+    }
+    return false;
+}
+
+bool ActiveTiles::step_tile(const LifeGrid& src, LifeGrid& dst, const Rule& rule, int tx, int ty, LifeStats& stats, uint64_t& hash) const
+{
+    const LifeKernel::RowFunction step_row = LifeKernel::row_function(rule);
+    const int word_begin = tx * TILE_WORDS;
+    const int word_end = std::min(word_begin + TILE_WORDS, m_words_per_row);
+    const int y_begin = ty * TILE_ROWS;
+    const int y_end = std::min(y_begin + TILE_ROWS, src.height());
+
+    bool changed = false;
+    for (int y = y_begin; y < y_end; ++y) {
+        const uint64_t* mid = src.row(y);
+        uint64_t* out = dst.row(y);
+
+        // dst still has the generation before src, compare the new words to those
+        uint64_t before[TILE_WORDS];
+        std::copy(out + word_begin, out + word_end, before);
+
+        step_row(src.row(y - 1) + word_begin, mid + word_begin, src.row(y + 1) + word_begin, out + word_begin, word_end - word_begin, rule);
+        if (word_end == m_words_per_row) {
+            out[word_end - 1] &= src.tail_mask();
+        }
+
+        for (int i = word_begin; i < word_end; ++i) {
+            const uint64_t old_word = before[i - word_begin];
+            if (out[i] != old_word) {
+                const uint64_t index = uint64_t(y) * m_words_per_row + i;
+                hash ^= LifeGrid::word_hash(old_word, index) ^ LifeGrid::word_hash(out[i], index);
+                changed = true;
+            }
+        }
+    }
+    stats.add_block(&src, dst, word_begin, word_end, y_begin, y_end); // while the tile is in the cache
+    return changed;
+}
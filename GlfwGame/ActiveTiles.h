@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "LifeStats.h"
+
+class LifeGrid;
+class ThreadPool;
+struct Rule;
+
+// Splits the grid into tiles and remembers which ones changed in the last step.
+// "changed" compares the new generation to the one before the old one (the buffer that was overwritten),
+// so blinkers and other period 2 oscillators count as settled, just like still lifes.
+// A tile is only stepped if it or one of its 8 neighbors changed, otherwise the buffer being written
+// already holds the right cells: nothing that could affect the tile was different two generations ago.
+// That only holds if the buffer being written came from stepping, so edits (and rule changes) mark tiles
+// for two steps, one for each buffer.
+// The stats of a generation come out of the same loop: a stepped tile is counted right after it is written,
+// a skipped one is back to the generation two before, so it has the population and box it had in that buffer,
+// and the births are the deaths of the last step (in the tile: births, less what the population grew by).
+// So does how LifeGrid::hash of dst changed, from the words that differ from what was in dst before.
+class ActiveTiles
+{
+public:
+	static constexpr int TILE_WORDS = 4; // 256 cells wide
+	static constexpr int TILE_ROWS = 16;
+
+	explicit ActiveTiles(const LifeGrid& grid);
+
+	// with a torus boundary the tiles at opposite edges are neighbors
+	void set_wrap(bool wrap) { m_wrap = wrap; }
+
+	void mark_all(); // after editing the whole grid, or changing the rule or boundary
+	void mark_cell(int x, int y); // after editing one cell
+
+	// step src into dst, where dst holds the generation before src. the halo of src has to be refreshed
+	void step(const LifeGrid& src, LifeGrid& dst, const Rule& rule, ThreadPool& pool);
+
+	int tile_count() const { return m_tiles_x * m_tiles_y; }
+	int active_count() const { return m_active_count; } // tiles stepped last generation
+	const LifeStats& stats() const { return m_stats; } // of dst after the last step, without the generation and deaths
+	// XOR of dst.hash() before and after the last step, so a hash of what dst had can be updated without hashing the grid
+	uint64_t hash_change() const { return m_hash_change; }
+
+private:
+	bool needs_step(int tx, int ty) const;
+	// returns if any cell changed, and XORs the word hashes of the changed words before and after into hash
+	bool step_tile(const LifeGrid& src, LifeGrid& dst, const Rule& rule, int tx, int ty, LifeStats& stats, uint64_t& hash) const;
+
+	int m_tiles_x, m_tiles_y;
+	int m_words_per_row;
+	bool m_wrap = false;
+	static constexpr uint8_t MARKED = 2; // in m_changed, edited since the last step
+
+	std::vector<uint8_t> m_changed; // per tile, changed in the last step (1) or MARKED
+	std::vector<uint8_t> m_next_changed;
+	int m_active_count = 0;
+
+	std::vector<LifeStats> m_tile_stats[2]; // per tile, of the buffer written last step ([m_stats_side]) and the other one
+	int m_stats_side = 0;
+	std::vector<LifeStats> m_row_stats; // per row of tiles, summed up after a step
+	LifeStats m_stats;
+	std::vector<uint64_t> m_row_hash_change; // per row of tiles
+	uint64_t m_hash_change = 0;
+};
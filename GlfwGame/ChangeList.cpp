@@ -0,0 +1,95 @@
+#include "ChangeList.h"
+#include "Rule.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    int count_trailing_zeros(uint64_t word) // word != 0
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return (int)index;
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+}
+
+ChangeList::ChangeList(int width, int height)
+    : m_queued(width, height)
+{
+}
+
+void ChangeList::mark_cell(int x, int y)
+{
+    if (m_valid) {
+        m_changed.push_back({ x, y });
+    }
+}
+
+void ChangeList::step(const LifeGrid& src, LifeGrid& dst, const Rule& rule, LifeGrid::Boundary boundary)
+{
+    const int width = src.width(), height = src.height();
+    const bool wrap = boundary == LifeGrid::Boundary::Torus;
+
+    // dst becomes a copy of src, then only the candidates can differ
+    m_candidates.clear();
+    for (const Cell& c : m_changed) {
+        dst.set(c.x, c.y, src.get(c.x, c.y));
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int x = c.x + dx, y = c.y + dy;
+                if (x < 0 || y < 0 || x >= width || y >= height) {
+                    if (!wrap) continue; // a dead or mirrored edge only reaches cells in the grid that are neighbors anyway
+                    x = (x + width) % width;
+                    y = (y + height) % height;
+                }
+                if (!m_queued.get(x, y)) {
+                    m_queued.set(x, y, true);
+                    m_candidates.push_back({ x, y });
+                }
+            }
+        }
+    }
+
+    // the halo has the cells past the edges, so the 8 neighbors can always be read
+    m_next_changed.clear();
+    for (const Cell& c : m_candidates) {
+        m_queued.set(c.x, c.y, false);
+        int neighbors = 0;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx || dy) neighbors += src.get(c.x + dx, c.y + dy);
+            }
+        }
+        const bool alive = src.get(c.x, c.y);
+        if (rule.next(alive, neighbors) != alive) {
+            dst.set(c.x, c.y, !alive);
+            m_next_changed.push_back(c);
+        }
+    }
+    m_changed.swap(m_next_changed);
+}
+
+void ChangeList::rebuild(const LifeGrid& src, const LifeGrid& dst)
+{
+    m_changed.clear();
+    for (int y = 0; y < src.height(); ++y) {
+        const uint64_t* a = src.row(y);
+        const uint64_t* b = dst.row(y);
+        for (int w = 0; w < src.words_per_row(); ++w) {
+            uint64_t diff = a[w] ^ b[w];
+            if (w == src.words_per_row() - 1) diff &= src.tail_mask();
+            while (diff) {
+                const int bit = count_trailing_zeros(diff);
+                m_changed.push_back({ w * 64 + bit, y });
+                diff &= diff - 1;
+            }
+        }
+    }
+    m_valid = true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "LifeGrid.h"
+
+struct Rule;
+
+// The cells that changed in the last generation. Only those and their neighbors can change in the next one,
+// so stepping from the list costs as much as there is activity, however big the grid is.
+// The buffer being written holds the generation before, which differs from the current one exactly at the listed cells.
+class ChangeList
+{
+public:
+	ChangeList(int width, int height);
+
+	bool valid() const { return m_valid; }
+	void invalidate() { m_valid = false; } // after editing the whole grid, nobody knows what changed
+	void mark_cell(int x, int y); // after editing one cell
+	size_t size() const { return m_changed.size(); }
+
+	struct Cell { int x, y; };
+	const std::vector<Cell>& changed() const { return m_changed; }
+
+	// step src into dst from the list, needs valid(). the halo of src has to be refreshed for boundary
+	void step(const LifeGrid& src, LifeGrid& dst, const Rule& rule, LifeGrid::Boundary boundary);
+	// after src was stepped into dst some other way: the list is whatever differs between them
+	void rebuild(const LifeGrid& src, const LifeGrid& dst);
+
+private:
+	bool m_valid = false;
+	std::vector<Cell> m_changed;
+	std::vector<Cell> m_next_changed;
+	std::vector<Cell> m_candidates; // changed cells and their neighbors, each once
+	LifeGrid m_queued; // which cells are in m_candidates
+};
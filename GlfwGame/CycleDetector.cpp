@@ -0,0 +1,28 @@
+#include "CycleDetector.h"
+
+void CycleDetector::reset()
+{
+    m_count = 0;
+    m_next = 0;
+    m_period = 0;
+    m_cycle_start = 0;
+}
+
+void CycleDetector::record(uint64_t hash, uint64_t generation)
+{
+    if (m_period) return;
+
+    // newest first, so the shortest period is found
+    for (int i = 1; i <= m_count; ++i) {
+        const Entry& e = m_history[(m_next - i + HISTORY) % HISTORY];
+        if (e.hash == hash) {
+            m_period = generation - e.generation;
+            m_cycle_start = e.generation;
+            return;
+        }
+    }
+
+    m_history[m_next] = { hash, generation };
+    m_next = (m_next + 1) % HISTORY;
+    if (m_count < HISTORY) ++m_count;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Remembers the hashes of the last HISTORY generations. When a hash comes back, the universe is in a cycle:
+// the same states repeat every period generations from then on (a still life has period 1).
+class CycleDetector
+{
+public:
+	static constexpr int HISTORY = 64; // longest period that can be found
+
+	void reset();
+	// after every generation, with the hash of the new state. does nothing once a cycle was found
+	void record(uint64_t hash, uint64_t generation);
+
+	uint64_t period() const { return m_period; } // 0 until a cycle is found
+	uint64_t cycle_start() const { return m_cycle_start; } // first generation of the cycle that was seen
+
+private:
+	struct Entry {
+		uint64_t hash;
+		uint64_t generation;
+	};
+	std::array<Entry, HISTORY> m_history;
+	int m_count = 0;
+	int m_next = 0; // ring buffer position
+	uint64_t m_period = 0;
+	uint64_t m_cycle_start = 0;
+};
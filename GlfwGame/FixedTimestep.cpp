@@ -0,0 +1,44 @@
+#include "FixedTimestep.h"
+
+#include <algorithm>
+#include <cmath>
+
+void FixedTimestep::set_rate(double rate)
+{
+    m_rate = rate;
+    m_due = std::min(m_due, 1.0); // don't start the new rate with a burst
+}
+
+void FixedTimestep::reset()
+{
+    m_due = 1.0; // the first one now, not a whole step later
+}
+
+void FixedTimestep::advance(double seconds)
+{
+    if (m_rate <= 0.0) return;
+    const double max_due = std::max(1.0, m_rate * MAX_CATCH_UP_SECONDS);
+    m_due = std::min(m_due + seconds * m_rate, max_due);
+}
+
+bool FixedTimestep::take()
+{
+    if (m_rate <= 0.0) return true;
+    if (m_due < 1.0) return false;
+    m_due -= 1.0;
+    return true;
+}
+
+uint64_t FixedTimestep::take_all()
+{
+    if (m_rate <= 0.0) return 0;
+    const double whole = std::floor(m_due);
+    m_due -= whole;
+    return (uint64_t)whole;
+}
+
+double FixedTimestep::seconds_until_next() const
+{
+    if (m_rate <= 0.0 || m_due >= 1.0) return 0.0;
+    return (1.0 - m_due) / m_rate;
+}
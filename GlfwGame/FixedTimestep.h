@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+// Steps at a fixed rate however often it's asked: the time that passes is added up, and every 1 / rate seconds
+// of it is one generation that is due. So a fast caller gets one every few calls and a slow one several per call.
+// When the caller falls far behind (a late frame, generations slower than the rate) only MAX_CATCH_UP_SECONDS
+// worth is kept, after that it just steps as fast as it can instead of owing more and more
+class FixedTimestep
+{
+public:
+	static constexpr double MAX_CATCH_UP_SECONDS = 0.25;
+
+	double rate() const { return m_rate; } // generations per second, 0 = unlimited
+	void set_rate(double rate);
+
+	void reset(); // one generation due right away and nothing owed, e.g. after a pause
+	void advance(double seconds); // time that passed
+	bool take(); // one generation if it's due, always with unlimited
+	uint64_t take_all(); // all that are due, 0 with unlimited
+	double seconds_until_next() const; // until take() is true, 0 if it is
+
+private:
+	double m_rate = 60.0;
+	double m_due = 0.0; // generations, the fraction is carried over
+};
@@ -0,0 +1,123 @@
+#include "Generations.h"
+#include "Rule.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+Generations::Generations(int width, int height)
+    : m_width(width), m_height(height)
+{
+}
+
+void Generations::set_states(int states)
+{
+    m_states = states;
+    for (auto& buffer : m_planes) {
+        buffer.assign(plane_count(states), LifeGrid(m_width, m_height));
+    }
+}
+
+void Generations::own_words()
+{
+    for (auto& buffer : m_planes) {
+        for (LifeGrid& plane : buffer) {
+            plane.own_words();
+        }
+    }
+}
+
+int Generations::plane_count(int states)
+{
+    // enough bits for the oldest age, states - 2
+    int planes = 0;
+    while (states > 2 && ((states - 2) >> planes) != 0) {
+        ++planes;
+    }
+    return planes;
+}
+
+int Generations::age(int x, int y) const
+{
+    int a = 0;
+    for (int i = 0; i < plane_count(); ++i) {
+        a |= int(plane(i).get(x, y)) << i;
+    }
+    return a;
+}
+
+int Generations::state(const LifeGrid& live, int x, int y) const
+{
+    if (live.get(x, y)) return 1;
+    const int a = age(x, y);
+    return a ? a + 1 : 0;
+}
+
+void Generations::clear_cell(int x, int y)
+{
+    for (LifeGrid& p : m_planes[m_buf_nr]) {
+        p.set(x, y, false);
+    }
+}
+
+void Generations::set_age(int x, int y, int age)
+{
+    for (int i = 0; i < plane_count(); ++i) {
+        m_planes[m_buf_nr][i].set(x, y, (age >> i) & 1);
+    }
+}
+
+void Generations::clear()
+{
+    for (auto& buffer : m_planes) {
+        for (LifeGrid& p : buffer) {
+            p.clear();
+        }
+    }
+}
+
+void Generations::step(const LifeGrid& before, LifeGrid& after, ThreadPool& pool)
+{
+    if (m_planes[0].empty()) return;
+
+    constexpr int ROWS_PER_TASK = 64;
+    const int tasks = (m_height + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    pool.run(tasks, [&](int task) {
+        step_rows(before, after, task * ROWS_PER_TASK, std::min(m_height, (task + 1) * ROWS_PER_TASK));
+    });
+    m_buf_nr = 1 - m_buf_nr;
+}
+
+void Generations::step_rows(const LifeGrid& before, LifeGrid& after, int y_begin, int y_end)
+{
+    const int planes = plane_count();
+    const int oldest = m_states - 2; // this age dies next
+    const int words = before.words_per_row();
+    const std::vector<LifeGrid>& src = m_planes[m_buf_nr];
+    std::vector<LifeGrid>& dst = m_planes[1 - m_buf_nr];
+
+    for (int y = y_begin; y < y_end; ++y) {
+        const uint64_t* live = before.row(y);
+        uint64_t* next_live = after.row(y);
+        for (int w = 0; w < words; ++w) {
+            // the age counter, 64 cells at a time
+            uint64_t age[Rule::MAX_STATES];
+            uint64_t dying = 0, is_oldest = ~uint64_t(0);
+            for (int i = 0; i < planes; ++i) {
+                age[i] = src[i].row(y)[w];
+                dying |= age[i];
+                is_oldest &= ((oldest >> i) & 1) ? age[i] : ~age[i];
+            }
+
+            next_live[w] &= ~dying;
+            const uint64_t died = live[w] & ~next_live[w];
+
+            // +1 with a ripple carry, the oldest go back to 0 (dead) and the ones that just died start at 1
+            uint64_t carry = dying;
+            for (int i = 0; i < planes; ++i) {
+                const uint64_t bit = age[i] ^ carry;
+                carry &= age[i];
+                dst[i].row(y)[w] = (bit & ~is_oldest) | (i == 0 ? died : 0);
+            }
+        }
+    }
+}
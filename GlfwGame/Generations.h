@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "LifeGrid.h"
+
+class ThreadPool;
+struct Rule;
+
+// The dying states of a Generations rule, next to the live cells in the usual LifeGrid.
+// A dying cell's age (1 for state 2, 2 for state 3 ..) is a counter split over bit planes,
+// bit i of the age is the cell's bit in plane i, so Brian's Brain (3 states) costs 2 bits per cell
+// with the live plane and 16 states cost 5. Double buffered like the live cells.
+class Generations
+{
+public:
+	Generations(int width, int height);
+
+	int states() const { return m_states; }
+	void set_states(int states); // all cells stop dying
+	static int plane_count(int states); // enough for the ages of a rule with that many states
+	int plane_count() const { return (int)m_planes[0].size(); }
+	const LifeGrid& plane(int i) const { return m_planes[m_buf_nr][i]; }
+
+	int age(int x, int y) const; // 0 if not dying
+	int state(const LifeGrid& live, int x, int y) const;
+	void clear_cell(int x, int y); // after editing a cell, it's alive or dead now
+	void set_age(int x, int y, int age);
+	void clear();
+	// replace the ages of the current generation, plane_count() grids of this size
+	void set_planes(std::vector<LifeGrid>&& planes) { m_planes[m_buf_nr] = std::move(planes); }
+	void own_words(); // see LifeGrid::own_words, for the planes of both generations
+
+	// after the live cells were stepped from before to after with the binary part of the rule:
+	// dying cells can't be born, live cells that didn't survive start dying and the dying get older.
+	// fixes after and steps the planes to the same generation
+	void step(const LifeGrid& before, LifeGrid& after, ThreadPool& pool);
+
+private:
+	void step_rows(const LifeGrid& before, LifeGrid& after, int y_begin, int y_end);
+
+	int m_states = 2;
+	int m_width, m_height;
+	std::array<std::vector<LifeGrid>, 2> m_planes;
+	int m_buf_nr = 0;
+};
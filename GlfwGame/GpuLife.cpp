@@ -0,0 +1,145 @@
+#include "GpuLife.h"
+#include "Layer.h"
+#include "Universe.h"
+
+#include <iostream>
+
+GpuLife::GpuLife(int width, int height)
+    : m_width(width), m_height(height)
+{
+    m_program = Layer::compile_shader_program("lifeStepVertex.glsl", "lifeStepFragment.glsl", "Life Step Shader");
+    m_u_size = glGetUniformLocation(m_program, "u_size");
+    m_u_boundary = glGetUniformLocation(m_program, "u_boundary");
+    m_u_birth = glGetUniformLocation(m_program, "u_birth");
+    m_u_survive = glGetUniformLocation(m_program, "u_survive");
+    m_u_states = glGetUniformLocation(m_program, "u_states");
+
+    // the two generations, bytes that are read exactly (no filtering) and can be rendered to
+    glGenTextures(2, m_textures);
+    glGenFramebuffers(2, m_FBOs);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    std::vector<uint8_t> zeros(size_t(width) * height, 0);
+    for (int i = 0; i < 2; ++i) {
+        glBindTexture(GL_TEXTURE_2D, m_textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, zeros.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_FBOs[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_textures[i], 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "ERROR::FRAMEBUFFER: life texture " << i << " is not complete\n";
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // full-screen quad
+    {
+        glGenVertexArrays(1, &m_VAO);
+        glBindVertexArray(m_VAO);
+
+        float vertices[] = {
+            -1.f, -1.f,
+            1.f, -1.f,
+            -1.f, 1.f,
+            1.f, 1.f
+        };
+
+        glGenBuffers(1, &m_VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+    }
+}
+
+GpuLife::~GpuLife()
+{
+    glDeleteProgram(m_program);
+    glDeleteBuffers(1, &m_VBO);
+    glDeleteVertexArrays(1, &m_VAO);
+    glDeleteFramebuffers(2, m_FBOs);
+    glDeleteTextures(2, m_textures);
+}
+
+bool GpuLife::supports_rule(const Rule& rule)
+{
+    return !rule.is_larger_than_life();
+}
+
+void GpuLife::set_rule(const Rule& rule)
+{
+    m_rule = rule;
+}
+
+void GpuLife::load(const Universe& universe)
+{
+    m_rule = universe.rule();
+    m_boundary = universe.boundary();
+    m_generation = universe.generation();
+
+    std::vector<uint8_t> states(size_t(m_width) * m_height);
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            states[size_t(y) * m_width + x] = (uint8_t)universe.state(x, y);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, m_textures[m_buf_nr]);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, GL_RED, GL_UNSIGNED_BYTE, states.data());
+}
+
+void GpuLife::store(Universe& universe) const
+{
+    std::vector<uint8_t> states;
+    read(states);
+    universe.set_states(states, m_generation);
+}
+
+void GpuLife::step(int generations)
+{
+    // the viewport is the grid while drawing into the textures, the window gets its own back afterwards
+    int viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glViewport(0, 0, m_width, m_height);
+
+    glUseProgram(m_program);
+    glBindVertexArray(m_VAO);
+    glUniform2i(m_u_size, m_width, m_height);
+    glUniform1i(m_u_boundary, (int)m_boundary);
+    glUniform1i(m_u_birth, m_rule.birth);
+    glUniform1i(m_u_survive, m_rule.survive);
+    glUniform1i(m_u_states, m_rule.states);
+    glActiveTexture(GL_TEXTURE0);
+
+    for (int i = 0; i < generations; ++i) {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_FBOs[1 - m_buf_nr]);
+        glBindTexture(GL_TEXTURE_2D, m_textures[m_buf_nr]);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        m_buf_nr = 1 - m_buf_nr;
+    }
+    m_generation += generations;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void GpuLife::set(int x, int y, int state)
+{
+    const uint8_t byte = (uint8_t)state;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, m_textures[m_buf_nr]);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, 1, 1, GL_RED, GL_UNSIGNED_BYTE, &byte);
+}
+
+void GpuLife::read(std::vector<uint8_t>& states) const
+{
+    states.resize(size_t(m_width) * m_height);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_FBOs[m_buf_nr]);
+    glReadPixels(0, 0, m_width, m_height, GL_RED, GL_UNSIGNED_BYTE, states.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
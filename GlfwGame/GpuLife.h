@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "LifeGrid.h"
+#include "Rule.h"
+
+class Universe;
+
+// The game of life on the gpu, with nothing but opengl 3.3 core (so Mesa's llvmpipe runs it too).
+// The state of every cell is one byte of an R8 texture (0 dead, 1 alive, 2.. dying), there are two of them
+// attached to framebuffers, and a generation is one draw of a full-screen quad into the other one.
+// The cells only come back to the cpu for edits of the whole grid and for statistics.
+// Needs a current opengl context for all of it, also for the destructor
+class GpuLife
+{
+public:
+	GpuLife(int width, int height);
+	~GpuLife();
+	GpuLife(const GpuLife&) = delete;
+	GpuLife& operator=(const GpuLife&) = delete;
+
+	// the 8 neighbors, Generations rules included (Larger than Life stays on the cpu)
+	static bool supports_rule(const Rule& rule);
+	const Rule& rule() const { return m_rule; }
+	void set_rule(const Rule& rule);
+	void set_boundary(LifeGrid::Boundary boundary) { m_boundary = boundary; }
+
+	void load(const Universe& universe); // the cells, rule, boundary and generation of the universe
+	void store(Universe& universe) const; // the other way, reads the cells back
+
+	void step(int generations = 1);
+	uint64_t generation() const { return m_generation; }
+
+	void set(int x, int y, int state); // one cell, without reading anything back
+	void read(std::vector<uint8_t>& states) const; // row by row, one byte per cell
+
+	// texture with the current generation, for drawing with texelFetch
+	unsigned int texture() const { return m_textures[m_buf_nr]; }
+
+private:
+	int m_width, m_height;
+	Rule m_rule;
+	LifeGrid::Boundary m_boundary = LifeGrid::Boundary::Dead;
+	uint64_t m_generation = 0;
+
+	unsigned int m_textures[2] = { 0, 0 };
+	unsigned int m_FBOs[2] = { 0, 0 };
+	int m_buf_nr = 0; // which texture is the current generation
+	unsigned int m_program = 0;
+	unsigned int m_VAO = 0, m_VBO = 0;
+
+	// uniform locations
+	int m_u_size, m_u_boundary, m_u_birth, m_u_survive, m_u_states;
+};
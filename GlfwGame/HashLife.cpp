@@ -0,0 +1,445 @@
+#include "HashLife.h"
+#include "LifeGrid.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+    constexpr int MIN_ROOT_LEVEL = 3;
+}
+
+size_t HashLife::Key_Hash::operator()(const Key& k) const
+{
+    // nodes are 8 byte aligned at least, mix the pointers so the low bits aren't all zero
+    uint64_t h = (uint64_t)(uintptr_t)k.nw;
+    h = h * 0x9E3779B97F4A7C15ull + (uint64_t)(uintptr_t)k.ne;
+    h = h * 0x9E3779B97F4A7C15ull + (uint64_t)(uintptr_t)k.sw;
+    h = h * 0x9E3779B97F4A7C15ull + (uint64_t)(uintptr_t)k.se;
+    return (size_t)(h ^ (h >> 29));
+}
+
+HashLife::HashLife()
+{
+    m_leaves[0] = { nullptr, nullptr, nullptr, nullptr, nullptr, 0, 0 };
+    m_leaves[1] = { nullptr, nullptr, nullptr, nullptr, nullptr, 1, 0 };
+    clear();
+}
+
+HashLife::Node* HashLife::leaf(bool alive) const
+{
+    return const_cast<Node*>(&m_leaves[alive ? 1 : 0]);
+}
+
+HashLife::Node* HashLife::empty(int level)
+{
+    if (m_empty.empty()) {
+        m_empty.push_back(leaf(false));
+    }
+    while ((int)m_empty.size() <= level) {
+        Node* e = m_empty.back();
+        m_empty.push_back(join(e, e, e, e));
+    }
+    return m_empty[level];
+}
+
+HashLife::Node* HashLife::join(Node* nw, Node* ne, Node* sw, Node* se)
+{
+    const Key key = { nw, ne, sw, se };
+    auto it = m_table.find(key);
+    if (it != m_table.end()) {
+        return it->second;
+    }
+    m_nodes.push_back({ nw, ne, sw, se, nullptr, nw->population + ne->population + sw->population + se->population, nw->level + 1 });
+    Node* node = &m_nodes.back();
+    m_table.emplace(key, node);
+    return node;
+}
+
+HashLife::Node* HashLife::expand(Node* node)
+{
+    Node* e = empty(node->level - 1);
+    return join(join(e, e, e, node->nw), join(e, e, node->ne, e),
+                join(e, node->sw, e, e), join(node->se, e, e, e));
+}
+
+HashLife::Node* HashLife::centered(Node* node)
+{
+    return join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+HashLife::Node* HashLife::result_level2(Node* node)
+{
+    // 4x4 cells as bits, bit (y * 4 + x)
+    int bits = 0;
+    const Node* quads[4] = { node->nw, node->ne, node->sw, node->se };
+    for (int q = 0; q < 4; ++q) {
+        const int qx = (q & 1) * 2, qy = (q >> 1) * 2;
+        const Node* c[4] = { quads[q]->nw, quads[q]->ne, quads[q]->sw, quads[q]->se };
+        for (int i = 0; i < 4; ++i) {
+            if (c[i]->population) {
+                bits |= 1 << ((qy + (i >> 1)) * 4 + qx + (i & 1));
+            }
+        }
+    }
+
+    Node* next[4];
+    for (int i = 0; i < 4; ++i) {
+        const int x = 1 + (i & 1), y = 1 + (i >> 1);
+        int neighbors = 0;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx || dy) neighbors += (bits >> ((y + dy) * 4 + x + dx)) & 1;
+            }
+        }
+        const bool alive = (bits >> (y * 4 + x)) & 1;
+        next[i] = leaf(m_rule.next(alive, neighbors));
+    }
+    return join(next[0], next[1], next[2], next[3]);
+}
+
+HashLife::Node* HashLife::result(Node* node)
+{
+    if (node->result) {
+        return node->result;
+    }
+    if (node->population == 0) {
+        return node->result = empty(node->level - 1);
+    }
+    if (node->level == 2) {
+        return node->result = result_level2(node);
+    }
+
+    Node* nw = node->nw; Node* ne = node->ne; Node* sw = node->sw; Node* se = node->se;
+
+    // 9 overlapping subnodes of level - 1, a 3x3 grid of them
+    Node* n00 = nw;
+    Node* n01 = join(nw->ne, ne->nw, nw->se, ne->sw);
+    Node* n02 = ne;
+    Node* n10 = join(nw->sw, nw->se, sw->nw, sw->ne);
+    Node* n11 = join(nw->se, ne->sw, sw->ne, se->nw);
+    Node* n12 = join(ne->sw, ne->se, se->nw, se->ne);
+    Node* n20 = sw;
+    Node* n21 = join(sw->ne, se->nw, sw->se, se->sw);
+    Node* n22 = se;
+
+    // full speed steps both halves of the time, otherwise only the second half steps
+    const bool full_speed = node->level - 2 <= m_step_exponent;
+    auto half = [&](Node* n) { return full_speed ? result(n) : centered(n); };
+
+    Node* r00 = half(n00); Node* r01 = half(n01); Node* r02 = half(n02);
+    Node* r10 = half(n10); Node* r11 = half(n11); Node* r12 = half(n12);
+    Node* r20 = half(n20); Node* r21 = half(n21); Node* r22 = half(n22);
+
+    return node->result = join(result(join(r00, r01, r10, r11)), result(join(r01, r02, r11, r12)),
+                               result(join(r10, r11, r20, r21)), result(join(r11, r12, r21, r22)));
+}
+
+bool HashLife::inner_half_only(Node* node) const
+{
+    return node->nw->nw->population == 0 && node->nw->ne->population == 0 && node->nw->sw->population == 0 &&
+           node->ne->nw->population == 0 && node->ne->ne->population == 0 && node->ne->se->population == 0 &&
+           node->sw->nw->population == 0 && node->sw->sw->population == 0 && node->sw->se->population == 0 &&
+           node->se->ne->population == 0 && node->se->sw->population == 0 && node->se->se->population == 0;
+}
+
+void HashLife::step()
+{
+    if (m_nodes.size() > m_max_nodes) {
+        collect_garbage();
+    }
+
+    // the root has to be big enough that nothing can leave its center half in 2^step_exponent generations
+    while (m_root->level < m_step_exponent + 2 || !inner_half_only(m_root)) {
+        m_root = expand(m_root);
+    }
+    m_root = result(expand(m_root));
+    m_half = int64_t(1) << (m_root->level - 1);
+}
+
+void HashLife::set_step_exponent(int exponent)
+{
+    if (exponent < 0) exponent = 0;
+    if (exponent == m_step_exponent) return;
+    m_step_exponent = exponent;
+    forget_results();
+}
+
+void HashLife::set_rule(const Rule& rule)
+{
+    if (rule == m_rule) return;
+    m_rule = rule;
+    forget_results();
+}
+
+void HashLife::forget_results()
+{
+    for (Node& node : m_nodes) {
+        node.result = nullptr;
+    }
+}
+
+bool HashLife::get(int64_t x, int64_t y) const
+{
+    x += m_origin_x;
+    y += m_origin_y;
+    if (x < -m_half || y < -m_half || x >= m_half || y >= m_half) {
+        return false;
+    }
+    return get(m_root, x + m_half, y + m_half);
+}
+
+bool HashLife::get(const Node* node, int64_t x, int64_t y) const
+{
+    while (node->level > 0) {
+        if (node->population == 0) return false;
+        const int64_t half = int64_t(1) << (node->level - 1);
+        const bool east = x >= half, south = y >= half;
+        node = south ? (east ? node->se : node->sw) : (east ? node->ne : node->nw);
+        if (east) x -= half;
+        if (south) y -= half;
+    }
+    return node->population != 0;
+}
+
+void HashLife::set(int64_t x, int64_t y, bool alive)
+{
+    x += m_origin_x;
+    y += m_origin_y;
+    while (x < -m_half || y < -m_half || x >= m_half || y >= m_half) {
+        m_root = expand(m_root);
+        m_half *= 2;
+    }
+    m_root = set(m_root, x + m_half, y + m_half, alive);
+}
+
+HashLife::Node* HashLife::set(Node* node, int64_t x, int64_t y, bool alive)
+{
+    if (node->level == 0) {
+        return leaf(alive);
+    }
+    const int64_t half = int64_t(1) << (node->level - 1);
+    const bool east = x >= half, south = y >= half;
+    if (east) x -= half;
+    if (south) y -= half;
+    Node* nw = node->nw; Node* ne = node->ne; Node* sw = node->sw; Node* se = node->se;
+    Node*& child = south ? (east ? se : sw) : (east ? ne : nw);
+    child = set(child, x, y, alive);
+    return join(nw, ne, sw, se);
+}
+
+void HashLife::clear()
+{
+    m_table.clear();
+    m_nodes.clear();
+    m_empty.clear();
+    m_root = empty(MIN_ROOT_LEVEL);
+    m_half = int64_t(1) << (MIN_ROOT_LEVEL - 1);
+}
+
+void HashLife::load(const LifeGrid& grid)
+{
+    clear();
+    center_origin(grid.width(), grid.height());
+    int level = MIN_ROOT_LEVEL;
+    while ((int64_t(1) << (level - 1)) < std::max(grid.width(), grid.height())) {
+        ++level;
+    }
+    m_half = int64_t(1) << (level - 1);
+    m_root = build(grid, level, -m_half - m_origin_x, -m_half - m_origin_y);
+}
+
+void HashLife::center_origin(int width, int height)
+{
+    m_origin_x = -(width / 2);
+    m_origin_y = -(height / 2);
+}
+
+HashLife::Node* HashLife::build(const LifeGrid& grid, int level, int64_t x, int64_t y)
+{
+    if (x >= grid.width() || y >= grid.height() || x + (int64_t(1) << level) <= 0 || y + (int64_t(1) << level) <= 0) {
+        return empty(level);
+    }
+    if (level == 0) {
+        return leaf(grid.get((int)x, (int)y));
+    }
+    if (level == 6 && x >= 0 && x + 64 <= grid.width()) { // one word of cells per row (maybe across two), skip it if it's all dead
+        const int word = int(x >> 6), shift = int(x & 63);
+        bool any = false;
+        for (int64_t row = std::max<int64_t>(y, 0); row < y + 64 && row < grid.height(); ++row) { // the tree starts above the grid
+            const uint64_t* r = grid.row((int)row);
+            any |= (shift ? (r[word] >> shift) | (r[word + 1] << (64 - shift)) : r[word]) != 0;
+        }
+        if (!any) return empty(level);
+    }
+    const int64_t half = int64_t(1) << (level - 1);
+    return join(build(grid, level - 1, x, y), build(grid, level - 1, x + half, y),
+                build(grid, level - 1, x, y + half), build(grid, level - 1, x + half, y + half));
+}
+
+void HashLife::store(LifeGrid& grid) const
+{
+    grid.clear();
+    store(m_root, grid, -m_half - m_origin_x, -m_half - m_origin_y);
+}
+
+void HashLife::store(const Node* node, LifeGrid& grid, int64_t x, int64_t y) const
+{
+    const int64_t size = int64_t(1) << node->level;
+    if (node->population == 0 || x >= grid.width() || y >= grid.height() || x + size <= 0 || y + size <= 0) {
+        return;
+    }
+    if (node->level == 0) {
+        grid.set((int)x, (int)y, true);
+        return;
+    }
+    const int64_t half = size / 2;
+    store(node->nw, grid, x, y);
+    store(node->ne, grid, x + half, y);
+    store(node->sw, grid, x, y + half);
+    store(node->se, grid, x + half, y + half);
+}
+
+HashLife::Node* HashLife::from_bits(uint64_t bits, int level, int x, int y)
+{
+    if (level == 0) {
+        return leaf(((bits >> (y * 8 + x)) & 1) != 0);
+    }
+    const int half = 1 << (level - 1);
+    return join(from_bits(bits, level - 1, x, y), from_bits(bits, level - 1, x + half, y),
+                from_bits(bits, level - 1, x, y + half), from_bits(bits, level - 1, x + half, y + half));
+}
+
+bool HashLife::read_macrocell(std::istream& in)
+{
+    // the nodes are joined into the table next to the old tree, which stays the root until the whole file is read,
+    // so a broken file leaves the tree as it was.
+    // Golly's top row is the highest y here, so north and south swap and the leaves are read bottom up
+    std::vector<Node*> lines(1, nullptr); // line numbers start at 1, 0 is an empty node of any level
+    std::string line;
+    while (std::getline(in, line)) {
+        const char first = line.empty() ? '#' : line[0];
+        if (first == '#' || first == '[' || first == '\r') continue; // header and comments
+
+        if (first == '.' || first == '*' || first == '$') { // 8x8 leaf, rows end with $
+            uint64_t bits = 0;
+            int x = 0, row = 0;
+            for (char c : line) {
+                if (c == '$') {
+                    x = 0;
+                    ++row;
+                    continue;
+                }
+                if (c != '.' && c != '*') continue;
+                if (x >= 8 || row >= 8) {
+                    std::cout << "ERROR::MACROCELL: leaf bigger than 8x8 on line " << lines.size() << "\n";
+                    return false;
+                }
+                if (c == '*') bits |= uint64_t(1) << ((7 - row) * 8 + x);
+                ++x;
+            }
+            lines.push_back(from_bits(bits, 3, 0, 0));
+            continue;
+        }
+
+        int level;
+        unsigned long long a, b, c, d; // golly's nw, ne, sw, se
+        if (std::sscanf(line.c_str(), "%d %llu %llu %llu %llu", &level, &a, &b, &c, &d) != 5 || level < 4 || level > 62) {
+            std::cout << "ERROR::MACROCELL: not a 2 state node on line " << lines.size() << ": " << line << "\n";
+            return false;
+        }
+        Node* children[4];
+        const unsigned long long numbers[4] = { c, d, a, b };
+        for (int i = 0; i < 4; ++i) {
+            if (numbers[i] >= lines.size() || (numbers[i] && lines[numbers[i]]->level != level - 1)) {
+                std::cout << "ERROR::MACROCELL: bad child " << numbers[i] << " on line " << lines.size() << "\n";
+                return false;
+            }
+            children[i] = numbers[i] ? lines[numbers[i]] : empty(level - 1);
+        }
+        lines.push_back(join(children[0], children[1], children[2], children[3]));
+    }
+    if (lines.size() == 1) {
+        std::cout << "ERROR::MACROCELL: no nodes\n";
+        return false;
+    }
+
+    m_root = lines.back(); // the last node is the root
+    while (m_root->level < MIN_ROOT_LEVEL) {
+        m_root = expand(m_root);
+    }
+    m_half = int64_t(1) << (m_root->level - 1);
+    collect_garbage(); // the old tree
+    return true;
+}
+
+void HashLife::write_macrocell(std::ostream& out) const
+{
+    std::unordered_map<const Node*, uint64_t> lines;
+    uint64_t line_count = 0;
+    if (write_macrocell(m_root, out, lines, line_count) == 0) { // the root is at least level 3, one empty leaf so there is a node
+        out << "$\n";
+    }
+}
+
+uint64_t HashLife::write_macrocell(const Node* node, std::ostream& out, std::unordered_map<const Node*, uint64_t>& lines, uint64_t& line_count) const
+{
+    if (node->population == 0) return 0;
+    auto it = lines.find(node);
+    if (it != lines.end()) return it->second;
+
+    if (node->level == 3) { // top row first, dead cells at the end of a row and empty rows at the end are left out
+        char text[8 * 9 + 2];
+        int length = 0, written = 0; // written: text up to the last live cell
+        for (int row = 0; row < 8; ++row) {
+            int row_end = length; // after the last live cell of the row
+            for (int x = 0; x < 8; ++x) {
+                const bool alive = get(node, x, 7 - row);
+                text[length++] = alive ? '*' : '.';
+                if (alive) row_end = length;
+            }
+            length = row_end;
+            text[length++] = '$';
+            if (row_end > 0 && text[row_end - 1] == '*') written = length;
+        }
+        text[written] = '\n';
+        out.write(text, written + 1);
+    }
+    else {
+        const uint64_t a = write_macrocell(node->sw, out, lines, line_count); // golly's nw is the top left
+        const uint64_t b = write_macrocell(node->se, out, lines, line_count);
+        const uint64_t c = write_macrocell(node->nw, out, lines, line_count);
+        const uint64_t d = write_macrocell(node->ne, out, lines, line_count);
+        out << node->level << ' ' << a << ' ' << b << ' ' << c << ' ' << d << '\n';
+    }
+    lines.emplace(node, ++line_count);
+    return line_count;
+}
+
+void HashLife::collect_garbage()
+{
+    // the old nodes stay alive until the tree is copied out of them, into a new table of this one.
+    // the leaves are members and don't move, so they are the same in both
+    std::deque<Node> old_nodes;
+    old_nodes.swap(m_nodes);
+    m_table.clear();
+    m_empty.clear();
+    std::unordered_map<Node*, Node*> copied;
+    m_root = copy(m_root, copied);
+}
+
+HashLife::Node* HashLife::copy(Node* node, std::unordered_map<Node*, Node*>& copied)
+{
+    if (node->level == 0) {
+        return leaf(node->population != 0);
+    }
+    auto it = copied.find(node);
+    if (it != copied.end()) {
+        return it->second;
+    }
+    Node* node_copy = join(copy(node->nw, copied), copy(node->ne, copied), copy(node->sw, copied), copy(node->se, copied));
+    copied.emplace(node, node_copy);
+    return node_copy;
+}
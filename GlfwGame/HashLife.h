@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <iosfwd>
+#include <unordered_map>
+#include <vector>
+
+#include "Rule.h"
+
+class LifeGrid;
+
+// HashLife: the universe is a quadtree where every distinct node exists only once (hash consed),
+// and every node remembers its RESULT: the center half of it, some generations into the future.
+// A node at level n is 2^n cells wide, its result is advanced 2^min(step_exponent, n - 2) generations,
+// so repeated structure in space and time is only ever computed once.
+// The universe is unbounded, the root is centered on (0, 0) and grows as the pattern does.
+// Cell (x, y) of get, set and the grids is (x + origin x, y + origin y) in the tree, so a pattern can sit anywhere in a grid.
+// Empty space has to stay empty, so rules with B0 can't be stepped here.
+class HashLife
+{
+public:
+	struct Node {
+		Node* nw; Node* ne; Node* sw; Node* se; // children, level - 1 (null for leaves)
+		Node* result; // memoized result for the current step exponent, level - 1
+		uint64_t population;
+		int level; // 2^level cells wide
+	};
+
+	HashLife();
+
+	bool get(int64_t x, int64_t y) const;
+	void set(int64_t x, int64_t y, bool alive);
+	void clear();
+	void load(const LifeGrid& grid); // replace everything with the cells of grid, centered (see center_origin)
+	void store(LifeGrid& grid) const; // the cells in the area of grid
+	// put the middle of a grid that big at (0, 0) of the tree
+	void center_origin(int width, int height);
+
+	// Golly's Macrocell format (.mc): every distinct node once, 8x8 leaves as text and bigger nodes as a level
+	// and the line numbers of their children, top row first. Reading joins every line into the canonical tree
+	// right away, so a file costs its number of distinct nodes, not its area. The root is centered on (0, 0).
+	// 2 state rules only. reading replaces everything but the origin, if the file is broken it prints an error,
+	// returns false and the tree is as it was
+	bool read_macrocell(std::istream& in);
+	void write_macrocell(std::ostream& out) const; // just the nodes, the [M2] and #R lines are up to the caller
+
+	// advance 2^step_exponent generations
+	void step();
+	int step_exponent() const { return m_step_exponent; }
+	void set_step_exponent(int exponent); // forgets memoized results, they are for the old step size
+
+	const Rule& rule() const { return m_rule; }
+	void set_rule(const Rule& rule); // forgets memoized results too
+
+	uint64_t population() const { return m_root->population; }
+	size_t node_count() const { return m_nodes.size(); }
+	// garbage collect when there are more than this many nodes before a step, only the tree of the root is kept
+	size_t max_nodes() const { return m_max_nodes; }
+	void set_max_nodes(size_t nodes) { m_max_nodes = nodes; }
+
+private:
+	Node* leaf(bool alive) const;
+	Node* empty(int level); // all dead node of level
+	Node* join(Node* nw, Node* ne, Node* sw, Node* se); // the canonical node with these children
+	Node* expand(Node* node); // one level bigger, node in the center
+	Node* centered(Node* node); // the center half, level - 1
+	Node* result(Node* node);
+	Node* result_level2(Node* node); // 4x4 -> center 2x2, one generation of the rule
+	bool inner_half_only(Node* node) const; // all live cells are in the center half
+	void forget_results();
+
+	bool get(const Node* node, int64_t x, int64_t y) const; // relative to the node's top left corner
+	Node* set(Node* node, int64_t x, int64_t y, bool alive);
+	Node* build(const LifeGrid& grid, int level, int64_t x, int64_t y); // node covering (x, y) to (x + 2^level, y + 2^level)
+	void store(const Node* node, LifeGrid& grid, int64_t x, int64_t y) const;
+	Node* from_bits(uint64_t bits, int level, int x, int y); // part of an 8x8 leaf, bit y * 8 + x
+	uint64_t write_macrocell(const Node* node, std::ostream& out, std::unordered_map<const Node*, uint64_t>& lines, uint64_t& line_count) const;
+
+	void collect_garbage(); // keep only the nodes reachable from the root
+	Node* copy(Node* node, std::unordered_map<Node*, Node*>& copied); // node of the old table, joined into the new one
+
+	struct Key {
+		Node* nw; Node* ne; Node* sw; Node* se;
+		bool operator==(const Key& o) const { return nw == o.nw && ne == o.ne && sw == o.sw && se == o.se; }
+	};
+	struct Key_Hash {
+		size_t operator()(const Key& k) const;
+	};
+
+
+	std::deque<Node> m_nodes; // deque so pointers stay valid while it grows
+	std::unordered_map<Key, Node*, Key_Hash> m_table;
+	std::vector<Node*> m_empty; // m_empty[level]
+	Node m_leaves[2];
+	Node* m_root;
+	int64_t m_half = 1; // root covers [-m_half, m_half) in both directions
+	int64_t m_origin_x = 0, m_origin_y = 0;
+	int m_step_exponent = 0;
+	Rule m_rule;
+	size_t m_max_nodes = size_t(1) << 23;
+};
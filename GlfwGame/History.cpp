@@ -0,0 +1,216 @@
+#include "History.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+    uint8_t* put_varint(uint8_t* out, uint64_t value)
+    {
+        while (value >= 0x80) {
+            *out++ = uint8_t(value | 0x80);
+            value >>= 7;
+        }
+        *out++ = uint8_t(value);
+        return out;
+    }
+
+    uint64_t get_varint(const uint8_t*& p)
+    {
+        uint64_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            const uint8_t byte = *p++;
+            value |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+    }
+}
+
+History::History(size_t max_bytes)
+    : m_max_bytes(max_bytes)
+{
+}
+
+void History::set_max_bytes(size_t bytes)
+{
+    m_max_bytes = bytes;
+    clear();
+}
+
+void History::clear()
+{
+    m_entries.clear();
+    m_bytes = 0;
+    m_bytes_since_keyframe = 0;
+    m_last.clear();
+    m_last_valid = m_before_last_valid = false;
+}
+
+size_t History::encode(const LifeGrid* before, const LifeGrid& after, std::vector<uint8_t>& out)
+{
+    // per changed word: the unchanged words before it, a byte with a bit for each changed byte, and those bytes.
+    // at most 10 bytes per word of the grid
+    const int words = after.words_per_row();
+    const size_t most = size_t(words) * after.height() * 10 + 16;
+    if (out.size() < most) out.resize(most);
+    uint8_t* p = out.data();
+    uint64_t unchanged = 0;
+    for (int y = 0; y < after.height(); ++y) {
+        const uint64_t* a = after.row(y);
+        const uint64_t* b = before ? before->row(y) : nullptr;
+        for (int w = 0; w < words; ++w) {
+            const uint64_t x = b ? a[w] ^ b[w] : a[w];
+            if (!x) {
+                ++unchanged;
+                continue;
+            }
+            p = put_varint(p, unchanged);
+            unchanged = 0;
+            uint8_t* mask = p++;
+            *mask = 0;
+            for (int i = 0; i < 8; ++i) {
+                const uint8_t byte = uint8_t(x >> (8 * i));
+                *mask |= uint8_t(byte ? 1 << i : 0);
+                *p = byte;
+                p += byte != 0;
+            }
+        }
+    }
+    return size_t(p - out.data());
+}
+
+void History::apply(const std::vector<uint8_t>& changes, LifeGrid& grid)
+{
+    const int words = grid.words_per_row();
+    const uint8_t* p = changes.data();
+    const uint8_t* end = p + changes.size();
+    uint64_t index = 0; // word of the grid, row by row
+    while (p < end) {
+        index += get_varint(p);
+        const uint8_t mask = *p++;
+        uint64_t x = 0;
+        for (int i = 0; i < 8; ++i) {
+            if (mask & (1 << i)) x |= uint64_t(*p++) << (8 * i);
+        }
+        grid.row(int(index / words))[index % words] ^= x;
+        ++index;
+    }
+}
+
+void History::record(const LifeGrid& grid, uint64_t generation)
+{
+    if (!enabled()) return;
+
+    // a different past from here on
+    while (!m_entries.empty() && m_entries.back().generation >= generation) {
+        m_bytes -= m_entries.back().changes.size();
+        m_entries.pop_back();
+    }
+    if (m_entries.empty() || m_entries.back().generation != m_last_generation) {
+        m_last_valid = false;
+    }
+
+    const bool after_last = m_last_valid && m_last_generation + 1 == generation;
+    const bool after_before_last = after_last && m_before_last_valid && generation - 2 >= m_keyframe;
+    Base base = Base::Nothing;
+    size_t length = 0;
+    if (after_last && generation - m_keyframe < MAX_KEYFRAME_INTERVAL) {
+        length = encode(&m_last[0], grid, m_scratch[0]);
+        base = Base::Last;
+        if (after_before_last) {
+            const size_t other = encode(&m_last[1], grid, m_scratch[1]);
+            if (other < length) {
+                std::swap(m_scratch[0], m_scratch[1]);
+                length = other;
+                base = Base::BeforeLast;
+            }
+        }
+        // once the changes since the keyframe are as big as it, a new one is about as cheap and quicker to restore
+        if (m_bytes_since_keyframe + length > m_entries[find(m_keyframe)].changes.size()) {
+            base = Base::Nothing;
+        }
+    }
+    if (base == Base::Nothing) {
+        length = encode(nullptr, grid, m_scratch[0]);
+        m_keyframe = generation;
+        m_bytes_since_keyframe = 0;
+    }
+    else {
+        m_bytes_since_keyframe += length;
+    }
+
+    m_entries.push_back({ generation, base, std::vector<uint8_t>(m_scratch[0].begin(), m_scratch[0].begin() + length) });
+    m_bytes += m_entries.back().changes.size();
+    while (m_bytes > m_max_bytes && m_entries.front().generation != m_keyframe) {
+        drop_oldest();
+    }
+
+    // the new last generation
+    if (m_last.size() != 2) {
+        m_last.assign(2, LifeGrid(grid.width(), grid.height()));
+    }
+    std::swap(m_last[0], m_last[1]);
+    m_before_last_valid = m_last_valid && m_last_generation + 1 == generation;
+    m_last[0] = grid;
+    m_last_generation = generation;
+    m_last_valid = true;
+}
+
+void History::drop_oldest()
+{
+    do {
+        m_bytes -= m_entries.front().changes.size();
+        m_entries.pop_front();
+    } while (!m_entries.empty() && m_entries.front().base != Base::Nothing);
+}
+
+size_t History::find(uint64_t generation) const
+{
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), generation,
+                               [](const Entry& e, uint64_t g) { return e.generation < g; });
+    if (it == m_entries.end() || it->generation != generation) return m_entries.size();
+    return size_t(it - m_entries.begin());
+}
+
+bool History::has(uint64_t generation) const
+{
+    return find(generation) != m_entries.size();
+}
+
+bool History::restore(uint64_t generation, LifeGrid& grid)
+{
+    const size_t index = find(generation);
+    if (index == m_entries.size()) return false;
+    size_t first = index;
+    while (m_entries[first].base != Base::Nothing) {
+        --first;
+    }
+
+    // replay from the keyframe with the last two generations, [0] is the newest
+    if (m_last.size() != 2) {
+        m_last.assign(2, LifeGrid(grid.width(), grid.height()));
+    }
+    m_last[0].clear();
+    apply(m_entries[first].changes, m_last[0]);
+    m_before_last_valid = false;
+    for (size_t i = first + 1; i <= index; ++i) {
+        const Entry& e = m_entries[i];
+        if (e.base == Base::Last) {
+            m_last[1] = m_last[0];
+        }
+        apply(e.changes, m_last[1]); // BeforeLast: [1] is the generation before the last one
+        std::swap(m_last[0], m_last[1]);
+        m_before_last_valid = true;
+    }
+    m_last_generation = generation;
+    m_last_valid = true;
+
+    // recording from here on compares to what was restored, the keyframe is the one before it
+    m_keyframe = m_entries[first].generation;
+    m_bytes_since_keyframe = 0;
+    for (size_t i = first + 1; i <= index; ++i) {
+        m_bytes_since_keyframe += m_entries[i].changes.size();
+    }
+    grid = m_last[0];
+    return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "LifeGrid.h"
+
+// The last generations of a grid, to go back to any of them, in a bounded amount of memory.
+// A generation is kept as the XOR with the one before it, or with the one before that when that has fewer
+// changes (oscillators of period 2 are most of what is left of a soup, they cancel out), as runs of unchanged
+// words and the changed bytes of the others. Every so often there is a keyframe, the whole grid the same way,
+// so restoring a generation only replays the changes since the keyframe before it. When the memory is used up
+// the oldest keyframe goes, with everything that needs it. Only the live cells, not the dying states
+class History
+{
+public:
+	static constexpr int MAX_KEYFRAME_INTERVAL = 256; // generations, at most that many changes are replayed
+
+	explicit History(size_t max_bytes = 0);
+
+	size_t max_bytes() const { return m_max_bytes; }
+	void set_max_bytes(size_t bytes); // 0 = off, forgets everything
+	bool enabled() const { return m_max_bytes != 0; }
+	void clear();
+
+	// after every step, with the grid of that generation. when it isn't the one after the newest kept,
+	// the kept generations from it on are a different past (after rewinding or loading) and are dropped
+	void record(const LifeGrid& grid, uint64_t generation);
+
+	bool empty() const { return m_entries.empty(); }
+	uint64_t oldest() const { return m_entries.front().generation; } // not empty
+	uint64_t newest() const { return m_entries.back().generation; }
+	bool has(uint64_t generation) const;
+	size_t bytes() const { return m_bytes; }
+
+	// the cells of that generation into grid (its size), returns false if it isn't kept.
+	// recording goes on from it: the next generation replaces the ones that were after it
+	bool restore(uint64_t generation, LifeGrid& grid);
+
+private:
+	enum class Base : uint8_t { Nothing, Last, BeforeLast }; // what the changes are to: keyframe, generation - 1, generation - 2
+
+	struct Entry {
+		uint64_t generation;
+		Base base;
+		std::vector<uint8_t> changes;
+	};
+
+	// runs of unchanged words and the changed ones between before (null for all dead) and after,
+	// into the start of out. returns how many bytes that is
+	static size_t encode(const LifeGrid* before, const LifeGrid& after, std::vector<uint8_t>& out);
+	static void apply(const std::vector<uint8_t>& changes, LifeGrid& grid); // grid ^= changes
+	size_t find(uint64_t generation) const; // index of the entry, m_entries.size() if it's not there
+	void drop_oldest(); // the first keyframe and its changes
+
+	size_t m_max_bytes;
+	size_t m_bytes = 0;
+	std::deque<Entry> m_entries; // generations in order, starting with a keyframe
+	uint64_t m_keyframe = 0; // generation of the newest keyframe
+	size_t m_bytes_since_keyframe = 0;
+
+	// the last two recorded (or restored) generations, what the next one is compared to
+	std::vector<LifeGrid> m_last; // [0] is m_last_generation, [1] the one before if m_before_last_valid
+	uint64_t m_last_generation = 0;
+	bool m_last_valid = false;
+	bool m_before_last_valid = false;
+	std::vector<uint8_t> m_scratch[2];
+};
@@ -0,0 +1,92 @@
+#include "LargerThanLife.h"
+#include "Rule.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    // the cell coordinate that i (in [-radius, size + radius)) reads, or -1 for dead
+    int boundary_source(int i, int size, LifeGrid::Boundary boundary)
+    {
+        if (i >= 0 && i < size) return i;
+        switch (boundary) {
+        case LifeGrid::Boundary::Torus: return ((i % size) + size) % size;
+        case LifeGrid::Boundary::Mirror: return std::min(std::max(i < 0 ? -i - 1 : 2 * size - 1 - i, 0), size - 1);
+        default: return -1;
+        }
+    }
+
+    inline int cell(const uint64_t* row, int x)
+    {
+        return int((row[x >> 6] >> (x & 63)) & 1);
+    }
+}
+
+void LargerThanLife::step(const LifeGrid& src, LifeGrid& dst, const Rule& rule, LifeGrid::Boundary boundary, ThreadPool& pool)
+{
+    const int width = src.width(), height = src.height();
+    const int r = rule.radius;
+
+    // which row and column every position around the grid reads
+    std::vector<int> source_y(height + 2 * r), source_x(width + 2 * r);
+    for (int i = 0; i < height + 2 * r; ++i) source_y[i] = boundary_source(i - r, height, boundary);
+    for (int i = 0; i < width + 2 * r; ++i) source_x[i] = boundary_source(i - r, width, boundary);
+
+    // next state for the count of the whole square, dead cells first and then live ones (which counted themselves)
+    const int max_count = (2 * r + 1) * (2 * r + 1);
+    std::vector<uint8_t> next(2 * (max_count + 1));
+    for (int n = 0; n < max_count; ++n) {
+        next[n] = rule.next(false, n);
+        next[max_count + 1 + n + 1] = rule.next(true, n); // indexed with the count including the live cell
+    }
+
+    constexpr int ROWS_PER_TASK = 32; // every band sums up its first square from scratch, so not too small
+    const int tasks = (height + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    pool.run(tasks, [&](int task) {
+        const int y_begin = task * ROWS_PER_TASK;
+        const int y_end = std::min(height, y_begin + ROWS_PER_TASK);
+
+        // column[i]: live cells of column source_x[i] in the rows of the square around y
+        std::vector<int> column_of_cell(width, 0);
+        std::vector<int> column(width + 2 * r);
+        auto add_row = [&](int padded_y, int sign) {
+            const int sy = source_y[padded_y];
+            if (sy < 0) return;
+            const uint64_t* row = src.row(sy);
+            for (int x = 0; x < width; ++x) {
+                column_of_cell[x] += sign * cell(row, x);
+            }
+        };
+        for (int i = y_begin; i <= y_begin + 2 * r; ++i) {
+            add_row(i, 1);
+        }
+
+        for (int y = y_begin; y < y_end; ++y) {
+            if (y > y_begin) { // move the square down a row
+                add_row(y - 1, -1);
+                add_row(y + 2 * r, 1);
+            }
+            for (int i = 0; i < width + 2 * r; ++i) {
+                column[i] = source_x[i] < 0 ? 0 : column_of_cell[source_x[i]];
+            }
+
+            const uint64_t* mid = src.row(y);
+            uint64_t* out = dst.row(y);
+            int sum = 0;
+            for (int i = 0; i < 2 * r; ++i) sum += column[i];
+            for (int w = 0; w < dst.words_per_row(); ++w) {
+                const int x_end = std::min(width, (w + 1) * 64);
+                uint64_t word = 0;
+                for (int x = w * 64; x < x_end; ++x) {
+                    sum += column[x + 2 * r]; // the square is now columns [x - r, x + r]
+                    const int alive = cell(mid, x);
+                    word |= uint64_t(next[alive * (max_count + 1) + sum]) << (x & 63);
+                    sum -= column[x];
+                }
+                out[w] = word;
+            }
+        }
+    });
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "LifeGrid.h"
+
+class ThreadPool;
+struct Rule;
+
+// Larger than Life: every cell counts the live cells in the (2 * radius + 1)^2 square around it.
+// The counts come from running box sums, a sum per column over the rows of the square that moves down one row
+// at a time, and a sum over the columns that moves right one cell at a time.
+// That is a couple of adds per cell for any radius, instead of (2 * radius + 1)^2 reads.
+namespace LargerThanLife
+{
+	// step src into dst with a Larger than Life rule. the boundary says what the cells up to radius outside the grid are,
+	// Mirror reflects the grid in its edges. the halos aren't used, bits past the width are cleared in dst
+	void step(const LifeGrid& src, LifeGrid& dst, const Rule& rule, LifeGrid::Boundary boundary, ThreadPool& pool);
+}
@@ -255,6 +255,39 @@ void Layer::end_of_loop()
     }
     m_start_time = glfwGetTime();
 }
+int Layer::start_offscreen()
+{
+    glfwSetErrorCallback(&Layer::error_callback);
+    if (!glfwInit()) {
+        std::cout << "ERROR::glfwInit() returned false\n";
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // nothing is drawn to the window itself, so the smallest one does
+    m_window = glfwCreateWindow(1, 1, "GLFWGame", NULL, NULL);
+    if (m_window == NULL) {
+        std::cout << "ERROR::GLFW: no opengl 3.3 context\n";
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(m_window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    return 0;
+}
+
 void Layer::clean_up()
 {
     glfwDestroyCursor(m_cursor);
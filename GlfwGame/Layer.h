@@ -44,6 +44,9 @@ public:
     static unsigned int compile_shader_program(const char* vertexShaderSource, const char* fragmentShaderSource, const char* name_for_error);
 
     int start();
+    // only an opengl 3.3 context, in an invisible window: for drawing into framebuffers, e.g. --headless --gpu.
+    // glfw still needs a display for that (xvfb-run on linux without one). clean_up() afterwards like after start()
+    int start_offscreen();
     
     bool loop_continue();
     // swap buffers, calculate framerate, set title, manage key api...
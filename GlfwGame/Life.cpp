@@ -1,11 +1,23 @@
 #include "Life.h"
 #include "Layer.h"
+#include "LifeKernel.h"
 
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-Life::Life() {
+const double Life::SPEEDS[] = { 0.5, 1.0, 2.0, 5.0, 10.0, 20.0, 30.0, 60.0, 120.0, 250.0, 500.0, 1000.0, 2000.0, 5000.0, 10000.0, 0.0 };
+
+Life::Life(int width, int height, LifeGrid::Boundary boundary, const Rule& rule, int threads)
+    : m_width(width), m_height(height), m_quad_length(2.f / std::max(width, height)),
+      m_simulation(width, height, boundary, rule, threads)
+{
     // random start seed
-    randomize();
+    m_simulation.with_universe([&](Universe& universe) {
+        universe.randomize(m_seed, m_density);
+        std::cout << "life: " << m_width << "x" << m_height << ", rule: " << universe.rule().to_string() << ", kernel: " << LifeKernel::isa_name(LifeKernel::isa()) << ", threads: " << universe.thread_count() << '\n';
+    });
 
     m_program = Layer::compile_shader_program("lifeVertex.glsl", "lifeFragment.glsl", "Life Shader");
 
@@ -41,23 +53,111 @@ Life::Life() {
 
         glGenBuffers(1, &m_colors_VBO);
         glBindBuffer(GL_ARRAY_BUFFER, m_colors_VBO);
-        std::array<float, m_TOTAL_CELLS> colors = {0.0f};
+        const std::vector<unsigned char> colors(size_t(m_width) * m_height, 0); // until the first frame
         
-        glBufferData(GL_ARRAY_BUFFER, sizeof(colors), (float*)&colors, GL_DYNAMIC_DRAW); // lesson: GPU seems to handle any amount of data
+        glBufferData(GL_ARRAY_BUFFER, colors.size(), colors.data(), GL_DYNAMIC_DRAW); // lesson: GPU seems to handle any amount of data
 
         glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 1 * sizeof(float), (void*)0);
+        glVertexAttribPointer(1, 1, GL_UNSIGNED_BYTE, GL_TRUE, 1, (void*)0); // bytes, normalized to 0.0 - 1.0 in the shader
         glVertexAttribDivisor(1, 1);
     }
     
     m_u_offset = glGetUniformLocation(m_program, "u_offset");
     m_u_quad_length = glGetUniformLocation(m_program, "u_quad_length");
+    m_u_from_texture = glGetUniformLocation(m_program, "u_from_texture");
+    m_u_states = glGetUniformLocation(m_program, "u_states");
     glUseProgram(m_program);
-    glUniform1i(glGetUniformLocation(m_program, "u_m_SIZE"), m_SIZE);
+    glUniform1i(glGetUniformLocation(m_program, "u_m_SIZE"), m_width); // cells per row of instances
+    glUniform1i(glGetUniformLocation(m_program, "u_cells"), 0); // texture unit
+}
+
+bool Life::set_gpu(bool on)
+{
+    if (on == m_on_gpu) return true;
+    bool possible = true;
+    m_simulation.set_idle(true); // the cells can't move while it steps them
+    m_simulation.with_universe([&](Universe& universe) {
+        if (!on) {
+            m_gpu->store(universe);
+            return;
+        }
+        if (!GpuLife::supports_rule(universe.rule())) {
+            std::cout << "ERROR::GPU: can't step " << universe.rule().to_string() << "\n";
+            possible = false;
+            return;
+        }
+        if (!m_gpu) {
+            m_gpu.reset(new GpuLife(m_width, m_height));
+        }
+        m_gpu->load(universe);
+    });
+    if (!possible) {
+        m_simulation.set_idle(false);
+        return false;
+    }
+    m_on_gpu = on;
+    m_simulation.set_idle(m_on_gpu);
+    std::cout << "stepping on the " << (m_on_gpu ? "gpu" : "cpu") << '\n';
+    return true;
+}
+
+bool Life::load_pattern(RleReader& reader)
+{
+    bool ok = true;
+    const RleReader::Header& header = reader.header();
+    const int left = (m_width - header.width) / 2;
+    const int top = (m_height - header.height) / 2 + header.height - 1;
+    m_simulation.with_universe([&](Universe& universe) {
+        ok = universe.load_cells([&](LifeGrid& grid) { return reader.read_cells(grid, left, top); });
+        if (m_on_gpu) m_gpu->load(universe);
+    });
+    return ok;
+}
+
+bool Life::load_macrocell(MacrocellReader& reader)
+{
+    bool ok = true;
+    m_simulation.with_universe([&](Universe& universe) {
+        ok = universe.load_tree([&](HashLife& tree) { return reader.read_nodes(tree); });
+        if (m_on_gpu) m_gpu->load(universe);
+    });
+    return ok;
+}
+
+bool Life::load_snapshot(const Snapshot& snapshot)
+{
+    bool ok = true;
+    m_simulation.with_universe([&](Universe& universe) {
+        ok = snapshot.load(universe);
+        if (m_on_gpu) m_gpu->load(universe);
+    });
+    return ok;
+}
+
+void Life::set_history(size_t bytes)
+{
+    edit([bytes](Universe& universe) { universe.set_history_bytes(bytes); });
+}
+
+void Life::set_speed(double generations_per_second)
+{
+    m_speed = generations_per_second;
+    m_simulation.set_rate(m_speed);
+    m_gpu_timestep.set_rate(m_speed);
+    if (m_speed == 0.0) {
+        std::cout << "speed: unlimited\n";
+    }
+    else {
+        std::cout << "speed: " << m_speed << " generations per second\n";
+    }
 }
 
 void Life::logic(Layer& layer)
 {
+    const double now = glfwGetTime();
+    const double frame_seconds = now - m_last_time;
+    m_last_time = now;
+
     //const float speed = 0.04f * (1.0f/m_zoom) * m_SIZE;
     const float speed = 0.04f;
     if (layer.key_state(GLFW_KEY_D).pressed) {
@@ -73,23 +173,21 @@ void Life::logic(Layer& layer)
         m_position.second -= speed;
     }
 
-    // left click -> turn on cell
-    if (layer.mouse_btn_state(GLFW_MOUSE_BUTTON_LEFT).pressed)
-    {    
-        auto mouse_pos = layer.mouse_pos_N();
-        int index = NC_to_buffer_index(mouse_pos.first, mouse_pos.second);
-
-        if (index >= 0 && index < m_TOTAL_CELLS) {
-            m_buffers[m_buf_nr][index] = true;
-        }
-    }
-    else if (layer.mouse_btn_state(GLFW_MOUSE_BUTTON_RIGHT).pressed) // right button -> kill cell
+    // left click -> turn on cell, right click -> kill cell
+    if (layer.mouse_btn_state(GLFW_MOUSE_BUTTON_LEFT).pressed || layer.mouse_btn_state(GLFW_MOUSE_BUTTON_RIGHT).pressed)
     {
         auto mouse_pos = layer.mouse_pos_N();
-        int index = NC_to_buffer_index(mouse_pos.first, mouse_pos.second);
+        auto cell = NC_to_cell(mouse_pos.first, mouse_pos.second);
 
-        if (index >= 0 && index < m_TOTAL_CELLS) {
-            m_buffers[m_buf_nr][index] = false;
+        if (cell.first >= 0 && cell.first < m_width && cell.second >= 0 && cell.second < m_height) {
+            const bool alive = layer.mouse_btn_state(GLFW_MOUSE_BUTTON_LEFT).pressed;
+            if (m_on_gpu) {
+                m_gpu->set(cell.first, cell.second, alive ? 1 : 0);
+            }
+            else {
+                const int x = cell.first, y = cell.second;
+                m_simulation.post([x, y, alive](Universe& universe) { universe.set(x, y, alive); });
+            }
         }
     }
 
@@ -108,24 +206,167 @@ void Life::logic(Layer& layer)
     }
     
     if (layer.key_state(GLFW_KEY_SPACE).just_pressed) {
-        m_paused = !m_paused;
+        if (m_simulation.paused()) {
+            m_gpu_timestep.reset(); // the same as the simulation thread does for itself
+        }
+        m_simulation.set_paused(!m_simulation.paused());
     }
     if (layer.key_state(GLFW_KEY_R).pressed) {
-        randomize();
+        randomize(m_seed + 1, m_density);
     }
     if (layer.key_state(GLFW_KEY_T).just_pressed) { // terminate
-        reset_to_0();
+        edit([](Universe& universe) { universe.clear(); });
+    }
+
+    // slower and faster, unlimited is the fastest
+    if (layer.key_state(GLFW_KEY_LEFT).just_pressed || layer.key_state(GLFW_KEY_RIGHT).just_pressed) {
+        const bool faster = layer.key_state(GLFW_KEY_RIGHT).just_pressed;
+        const int count = (int)(sizeof(SPEEDS) / sizeof(SPEEDS[0]));
+        const double unlimited = std::numeric_limits<double>::infinity();
+        const double current = m_speed == 0.0 ? unlimited : m_speed;
+        double next = m_speed;
+        for (int i = 0; i < count; ++i) {
+            const double speed = SPEEDS[i] == 0.0 ? unlimited : SPEEDS[i];
+            if (faster && speed > current) { next = SPEEDS[i]; break; }
+            if (!faster && speed < current) next = SPEEDS[i];
+        }
+        if (next != m_speed) set_speed(next);
+    }
+
+    // step on the gpu (P for pixel shader) or the cpu
+    if (layer.key_state(GLFW_KEY_P).just_pressed) {
+        set_gpu(!m_on_gpu);
+    }
+
+    // next (E)ngine, up and down doubles or halves the HashLife step
+    if (layer.key_state(GLFW_KEY_E).just_pressed) {
+        m_simulation.post([](Universe& universe) {
+            const int next = ((int)universe.engine() + 1) % (int)Universe::Engine::COUNT;
+            if (!universe.set_engine((Universe::Engine)next)) {
+                std::cout << "ERROR::ENGINE: " << Universe::engine_name((Universe::Engine)next) << " can't step " << universe.rule().to_string() << "\n";
+            }
+            std::cout << "engine: " << Universe::engine_name(universe.engine()) << '\n';
+        });
+    }
+    const int exponent_change = (int)layer.key_state(GLFW_KEY_UP).just_pressed - (int)layer.key_state(GLFW_KEY_DOWN).just_pressed;
+    if (exponent_change) {
+        m_simulation.post([exponent_change](Universe& universe) {
+            const int exponent = std::max(0, universe.hashlife_step_exponent() + exponent_change);
+            if (universe.engine() == Universe::Engine::HashLife && exponent != universe.hashlife_step_exponent()) {
+                universe.set_hashlife_step_exponent(exponent);
+                std::cout << "hashlife step: 2^" << exponent << " generations\n";
+            }
+        });
+    }
+
+    // next (B)oundary
+    if (layer.key_state(GLFW_KEY_B).just_pressed) {
+        edit([](Universe& universe) {
+            const int next = ((int)universe.boundary() + 1) % (int)LifeGrid::Boundary::COUNT;
+            universe.set_boundary((LifeGrid::Boundary)next);
+            std::cout << "boundary: " << LifeGrid::boundary_name(universe.boundary()) << '\n';
+        });
+    }
+
+    // write the cells as a pattern (O for output)
+    if (layer.key_state(GLFW_KEY_O).just_pressed) {
+        edit([](Universe& universe) {
+            if (write_rle(SAVE_PATH, universe.grid(), universe.rule())) {
+                std::cout << "saved " << SAVE_PATH << '\n';
+            }
+        });
+    }
+    if (layer.key_state(GLFW_KEY_M).just_pressed) {
+        edit([](Universe& universe) {
+            if (write_macrocell(MACROCELL_PATH, universe)) {
+                std::cout << "saved " << MACROCELL_PATH << '\n';
+            }
+        });
+    }
+    if (layer.key_state(GLFW_KEY_K).just_pressed) {
+        edit([](Universe& universe) {
+            if (write_snapshot(SNAPSHOT_PATH, universe)) {
+                std::cout << "saved " << SNAPSHOT_PATH << '\n';
+            }
+        });
+    }
+
+    // (J)ump ahead, instantly once the universe is known to repeat itself. the cycle detection is on the cpu.
+    // without a cycle that would be stepping all of them, which with the cells on the gpu happens right here
+    if (layer.key_state(GLFW_KEY_J).just_pressed) {
+        edit([](Universe& universe) {
+            if (!universe.period()) {
+                std::cout << "jump: no cycle found yet\n";
+                return;
+            }
+            universe.jump(JUMP_GENERATIONS);
+            std::cout << "generation: " << universe.generation() << '\n';
+        });
     }
 
     // more LIFEY logic
-    if (m_paused) {
+    if (m_simulation.paused()) {
         if (layer.key_state(GLFW_KEY_G).just_pressed) { // next (G)eneration
-            next_generation();
+            step(1);
+        }
+        // through the history with , and . (< and >), a generation per frame while held. past the newest one . steps
+        const bool back = layer.key_state(GLFW_KEY_COMMA).pressed;
+        const bool just_back = layer.key_state(GLFW_KEY_COMMA).just_pressed;
+        if (back || layer.key_state(GLFW_KEY_PERIOD).pressed) {
+            edit([back, just_back](Universe& universe) {
+                const uint64_t generation = universe.generation();
+                if (back ? generation > 0 && universe.rewind(generation - 1) : universe.rewind(generation + 1)) {
+                    std::cout << "generation: " << universe.generation() << '\n';
+                }
+                else if (!back) {
+                    universe.step();
+                }
+                else if (just_back && !universe.history().enabled()) {
+                    std::cout << "history: off, --history MB keeps the last generations\n";
+                }
+            });
         }
     }
-    else {
-        next_generation();
+    else if (m_on_gpu) { // the simulation thread keeps its own time
+        m_gpu_timestep.advance(frame_seconds);
+        const int generations = m_speed == 0.0 ? GPU_UNLIMITED_GENERATIONS : (int)m_gpu_timestep.take_all();
+        if (generations) step(generations);
+    }
+
+    // the simulation stops when nothing new will happen, once per cycle
+    m_new_frame |= m_simulation.update_frame();
+    const Simulation::Frame& frame = m_simulation.frame();
+    if (frame.period != m_reported_period) {
+        m_reported_period = frame.period;
+        if (m_reported_period) {
+            std::cout << "cycle: period " << m_reported_period << " since generation " << frame.cycle_start
+                      << ", paused. SPACE to keep stepping, J to jump " << JUMP_GENERATIONS << " generations\n";
+        }
+    }
+}
+
+void Life::randomize(uint64_t seed, double density)
+{
+    m_seed = seed;
+    m_density = density;
+    edit([seed, density](Universe& universe) {
+        universe.randomize(seed, density);
+        std::cout << "soup: seed " << seed << ", density " << density << '\n';
+    });
+}
+
+void Life::edit(const std::function<void(Universe&)>& change)
+{
+    if (!m_on_gpu) {
+        m_simulation.post(change);
+        return;
     }
+    // the simulation is idle, the cells go through the cpu and back
+    m_simulation.with_universe([&](Universe& universe) {
+        m_gpu->store(universe);
+        change(universe);
+        m_gpu->load(universe);
+    });
 }
 
 void Life::draw(Layer& layer)
@@ -137,70 +378,42 @@ void Life::draw(Layer& layer)
 
         glUniform1f(m_u_quad_length, m_quad_length); // side length of quads
         glUniform2f(m_u_offset, m_position.first, m_position.second); // offset for all
+        glUniform1i(m_u_from_texture, m_on_gpu);
 
-        // black and white data
-        {
-            float colors[m_SIZE][m_SIZE];
-
-            for (int i = 0; i < m_SIZE; ++i) {
-                for (int j = 0; j < m_SIZE; ++j) {
-                    colors[i][j] = (float)m_buffers[m_buf_nr][i * m_SIZE + j];
-                }
-            }
-
+        if (m_on_gpu) { // the vertex shader reads the states straight from the texture
+            glUniform1i(m_u_states, m_gpu->rule().states);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, m_gpu->texture());
+        }
+        // new frame from the simulation thread, one byte per cell
+        else if (m_new_frame) {
+            m_new_frame = false;
+            const Simulation::Frame& frame = m_simulation.frame();
             glBindBuffer(GL_ARRAY_BUFFER, m_colors_VBO);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(colors), (float*)colors);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, frame.colors.size(), frame.colors.data());
         }
 
-        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, m_TOTAL_CELLS);
+        // one instance per cell, main doesn't open a window with more than fit in a GLsizei
+        const int64_t cells = int64_t(m_width) * m_height;
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, (GLsizei)std::min<int64_t>(cells, std::numeric_limits<GLsizei>::max()));
     }
 }
 
-int Life::NC_to_buffer_index(float x, float y)
-{
-    // relative coords to LIFE square
-    float rel_x = x - m_position.first;
-    float rel_y = y - m_position.second;
-
-    // divide by length of square
-    float sq_length = m_quad_length * m_SIZE;
-    rel_x /= sq_length;
-    rel_y /= sq_length;
-
-    return int(rel_x * m_SIZE) + m_SIZE * int(rel_y * m_SIZE); // index
-}
-
-void Life::randomize()
+void Life::step(int generations)
 {
-    for (int i = 1; i < m_SIZE - 1; ++i) {
-        for (int j = 1; j < m_SIZE - 1; ++j) {
-            m_buffers[m_buf_nr][i * m_SIZE + j] = ((rand() % 2) == 0);
-        }
+    if (m_on_gpu) {
+        m_gpu->step(generations);
+    }
+    else {
+        m_simulation.post([generations](Universe& universe) { universe.step((uint64_t)generations); });
     }
 }
 
-void Life::reset_to_0()
+std::pair<int, int> Life::NC_to_cell(float x, float y) const
 {
-    m_buffers[m_buf_nr] = { false };
-}
+    // relative coords to LIFE square, divided by length of one cell
+    float rel_x = (x - m_position.first) / m_quad_length;
+    float rel_y = (y - m_position.second) / m_quad_length;
 
-void Life::next_generation() // set (1 - m_buf_nr) to new buffer, then copy 
-{
-    const int old_buf = m_buf_nr;
-    m_buf_nr = 1 - old_buf;
-    const int new_buf = m_buf_nr;
-
-    // apply algorithm on all EXCEPT BORDERS
-    for (int i = 1; i < m_SIZE - 1; ++i) {
-        for (int j = 1; j < m_SIZE - 1; ++j) {
-            auto& m = m_buffers[old_buf]; // shorthand
-            const int p_up = (i - 1) * m_SIZE + j, p_mid = (i) * m_SIZE + j, p_down = (i + 1) * m_SIZE + j;
-            int neighbors = m[p_up - 1]   + m[p_up]   + m[p_up + 1] +
-                            m[p_mid - 1]  +             m[p_mid + 1] +
-                            m[p_down - 1] + m[p_down] + m[p_down + 1];
-            
-            // if alive, alive if 2 or 3 neighbors, if dead, alive if 3 neighbors
-            m_buffers[new_buf][p_mid] = m[p_mid] ? (2 <= neighbors && neighbors <= 3) : (neighbors == 3);
-        }
-    }
+    return { (int)std::floor(rel_x), (int)std::floor(rel_y) };
 }
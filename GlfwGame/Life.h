@@ -1,32 +1,81 @@
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <utility>
-#include <array>
-#include <bitset>
+#include <vector>
+
+#include "Simulation.h"
+#include "GpuLife.h"
+#include "Macrocell.h"
+#include "Rle.h"
+#include "Snapshot.h"
 
 class Layer;
 
 class Life
 {
 public:
-	Life();
+	// cells in each direction, what is past the edges, the rule, threads for stepping generations (0 = all cores)
+	Life(int width, int height, LifeGrid::Boundary boundary, const Rule& rule, int threads = 0);
 	void logic(Layer& layer);
 	void draw(Layer& layer);
 
+	// advance generations, on the gpu or with Universe::step(times), which keeps bands of rows in the cache for several of them
+	void step(int generations);
+
+	// step on the gpu (GpuLife) instead of the Universe, the cells move over.
+	// returns false if the gpu can't step the rule
+	bool set_gpu(bool on);
+
+	// replaces all cells with the pattern, centered. false if the file is broken
+	bool load_pattern(RleReader& reader);
+	// replaces all cells with the tree, its middle in the middle of the grid (see Universe::load_tree)
+	bool load_macrocell(MacrocellReader& reader);
+	// the universe as it was saved, the snapshot has to be the size of this one
+	bool load_snapshot(const Snapshot& snapshot);
+
+	// a new soup, every cell alive with probability density (see Universe::randomize). R makes the one of the next seed
+	void randomize(uint64_t seed, double density);
+
+	// memory for going back through the last generations with , and . while paused, 0 = none (see History)
+	void set_history(size_t bytes);
+
+	// population, births, deaths and box of the generation drawn last (see Universe::stats), from the cpu:
+	// while on the gpu they are of the last generation the universe had
+	const LifeStats& stats() const { return m_simulation.frame().stats; }
+	// the stats of every generation since the last call, appended to stats (see Simulation::take_stats)
+	void take_stats(std::vector<LifeStats>& stats) { m_simulation.take_stats(stats); }
+
+	// generations per second while not paused, 0 = unlimited. LEFT and RIGHT go through SPEEDS
+	void set_speed(double generations_per_second);
+
 private:
-	int NC_to_buffer_index(float x, float y); // opengl normalized coords to index in m_buffers[m_buf_nr][HERE]
-	void randomize(); // set matrix to random bool values
-	void reset_to_0(); // set matrix to false for all values
-	void next_generation(); // transform 
-
-	static constexpr int m_SIZE = 200; // how many cells in each direction
-	static constexpr int m_TOTAL_CELLS = m_SIZE * m_SIZE;
-	bool m_paused = true;
-	float m_quad_length = 2.f/m_SIZE;
+	std::pair<int, int> NC_to_cell(float x, float y) const; // opengl normalized coords to cell x and y (may be outside the grid)
+	// change the universe on the simulation thread, or with the cells read back from the gpu
+	void edit(const std::function<void(Universe&)>& change);
+
+	static constexpr uint64_t JUMP_GENERATIONS = 1000000;
+	static constexpr int GPU_UNLIMITED_GENERATIONS = 64; // per frame at unlimited speed, more and the frames wait for the gpu
+	static const double SPEEDS[];
+	static constexpr const char* SAVE_PATH = "life.rle"; // where O writes the cells
+	static constexpr const char* MACROCELL_PATH = "life.mc"; // and M, with all of the HashLife tree
+	static constexpr const char* SNAPSHOT_PATH = "life.snap"; // and K, all of the universe as it is in memory
+
+	const int m_width; // how many cells in each direction
+	const int m_height;
+	uint64_t m_reported_period = 0; // cycle that was already reported
+	float m_quad_length;
 	std::pair<float, float> m_position = { -1.f, -1.f }; // offset viewing position, X AND Y
-	std::array<std::bitset<m_TOTAL_CELLS>, 2> m_buffers;
-	//std::array<std::array<bool,m_TOTAL_CELLS>, 2> m_buffers;
-	int m_buf_nr = 0; // which buffer is currently active
+	Simulation m_simulation;
+	bool m_new_frame = false; // from m_simulation, not uploaded yet
+	std::unique_ptr<GpuLife> m_gpu; // made the first time it's used
+	bool m_on_gpu = false; // the cells are in m_gpu, the universe is out of date and the simulation idle
+	double m_speed = 60.0;
+	uint64_t m_seed = 0; // of the last soup
+	double m_density = 0.5;
+	FixedTimestep m_gpu_timestep; // the simulation thread has its own
+	double m_last_time = 0.0; // of the last frame
 
 	// opengl stuff
 	unsigned int m_program = 0;
@@ -35,4 +84,6 @@ private:
 	// uniform locations
 	int m_u_offset;
 	int m_u_quad_length;
+	int m_u_from_texture;
+	int m_u_states;
 };
\ No newline at end of file
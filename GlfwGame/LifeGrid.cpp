@@ -0,0 +1,182 @@
+#include "LifeGrid.h"
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+LifeGrid::LifeGrid(int width, int height)
+{
+    set_size(width, height);
+    m_words.assign(word_count(), 0);
+    m_data = m_words.data();
+}
+
+LifeGrid::LifeGrid(int width, int height, uint64_t* words, std::shared_ptr<void> owner)
+    : m_owner(std::move(owner)), m_data(words)
+{
+    set_size(width, height);
+}
+
+LifeGrid::LifeGrid(const LifeGrid& other)
+{
+    *this = other;
+}
+
+LifeGrid& LifeGrid::operator=(const LifeGrid& other)
+{
+    if (this != &other) {
+        set_size(other.m_width, other.m_height);
+        m_words.assign(other.m_data, other.m_data + other.word_count());
+        m_owner.reset();
+        m_data = m_words.data();
+    }
+    return *this;
+}
+
+void LifeGrid::own_words()
+{
+    if (m_owner) {
+        *this = LifeGrid(*this);
+    }
+}
+
+void LifeGrid::set_size(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    m_words_per_row = (width + 63) / 64;
+    m_stride = m_words_per_row + 2;
+    m_tail_mask = (width % 64 == 0) ? ~uint64_t(0) : ((uint64_t(1) << (width % 64)) - 1);
+}
+
+bool LifeGrid::get(int x, int y) const
+{
+    return (row(y)[x >> 6] >> (x & 63)) & 1;
+}
+
+void LifeGrid::set(int x, int y, bool alive)
+{
+    uint64_t& word = row(y)[x >> 6];
+    const uint64_t bit = uint64_t(1) << (x & 63);
+    word = alive ? (word | bit) : (word & ~bit);
+}
+
+void LifeGrid::clear()
+{
+    std::fill(m_data, m_data + word_count(), 0);
+}
+
+const char* LifeGrid::boundary_name(Boundary boundary)
+{
+    switch (boundary) {
+    case Boundary::Torus: return "Torus";
+    case Boundary::Mirror: return "Mirror";
+    default: return "Dead";
+    }
+}
+
+void LifeGrid::refresh_halo(Boundary boundary)
+{
+    if (boundary == Boundary::Dead) {
+        clear_halo();
+        return;
+    }
+
+    // halo columns first, then the halo rows copy whole rows including their halo words, which fills the corners
+    refresh_halo_columns(boundary, 0, m_height);
+
+    const bool torus = boundary == Boundary::Torus;
+    const uint64_t* north_source = row(torus ? m_height - 1 : 0) - 1; // row copied to y = -1
+    const uint64_t* south_source = row(torus ? 0 : m_height - 1) - 1; // row copied to y = height
+    std::copy(north_source, north_source + m_stride, row(-1) - 1);
+    std::copy(south_source, south_source + m_stride, row(m_height) - 1);
+}
+
+void LifeGrid::refresh_halo_columns(Boundary boundary, int y_begin, int y_end)
+{
+    const bool dead = boundary == Boundary::Dead;
+    const bool torus = boundary == Boundary::Torus;
+    const int west_source = torus ? m_width - 1 : 0; // cell copied to x = -1
+    const int east_source = torus ? 0 : m_width - 1; // cell copied to x = width
+    const uint64_t east_bit = uint64_t(1) << (m_width & 63);
+
+    for (int y = y_begin; y < y_end; ++y) {
+        uint64_t* r = row(y);
+        r[-1] = dead ? 0 : uint64_t(get(west_source, y)) << 63;
+        const bool east = !dead && get(east_source, y);
+        uint64_t& east_word = r[m_width >> 6]; // last word, or the halo word
+        if (m_width & 63) { // inside the last word, the rest of it is cells
+            east_word = (east_word & m_tail_mask) | (east ? east_bit : 0);
+        }
+        else {
+            east_word = uint64_t(east);
+        }
+    }
+}
+
+int LifeGrid::popcount(uint64_t word)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    return (int)__popcnt64(word);
+#elif defined(_MSC_VER)
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((word * 0x0101010101010101ull) >> 56);
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+uint64_t LifeGrid::population() const
+{
+    uint64_t count = 0;
+    for (int y = 0; y < m_height; ++y) {
+        const uint64_t* r = row(y);
+        for (int w = 0; w < m_words_per_row - 1; ++w) {
+            count += popcount(r[w]);
+        }
+        count += popcount(r[m_words_per_row - 1] & m_tail_mask);
+    }
+    return count;
+}
+
+uint64_t LifeGrid::word_hash(uint64_t word, uint64_t index)
+{
+    // splitmix64 of the word, offset by its position
+    uint64_t z = word + index * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint64_t LifeGrid::word_hash(int w, int y, uint64_t salt) const
+{
+    const uint64_t word = row(y)[w] & (w == m_words_per_row - 1 ? m_tail_mask : ~uint64_t(0));
+    return word_hash(word, uint64_t(y) * m_words_per_row + w + salt);
+}
+
+uint64_t LifeGrid::hash(uint64_t salt) const
+{
+    uint64_t h = 0;
+    for (int y = 0; y < m_height; ++y) {
+        for (int w = 0; w < m_words_per_row; ++w) {
+            h ^= word_hash(w, y, salt);
+        }
+    }
+    return h;
+}
+
+void LifeGrid::clear_halo()
+{
+    std::fill(row(-1) - 1, row(-1) - 1 + m_stride, 0);
+    std::fill(row(m_height) - 1, row(m_height) - 1 + m_stride, 0);
+    for (int y = 0; y < m_height; ++y) {
+        uint64_t* r = row(y);
+        r[-1] = 0;
+        r[m_words_per_row - 1] &= m_tail_mask;
+        r[m_words_per_row] = 0;
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Game of life matrix packed 64 cells per word.
+// Every row has one extra word on each side and there is one extra row above and below (the halo),
+// so the kernels can read all 8 neighbors of any cell without checking for edges.
+// cell (x, y) is bit (x % 64) of word (x / 64) in row(y), row(-1) and row(height) are halo rows.
+// The halo column x = width is the first bit past the width, which is inside the last word unless width % 64 == 0
+class LifeGrid
+{
+public:
+	// what the cells just outside the grid are, when stepping
+	enum class Boundary {
+		Dead, // always dead
+		Torus, // the opposite edge, gliders come back on the other side
+		Mirror, // the edge cell itself, as if reflected in the edge
+		COUNT
+	};
+	static const char* boundary_name(Boundary boundary);
+
+	LifeGrid(int width, int height);
+	// a grid on memory that isn't its own, word_count() words laid out like words(), e.g. a mapped snapshot file.
+	// owner keeps the memory alive while the grid (or what it is moved to) uses it, copies get their own
+	LifeGrid(int width, int height, uint64_t* words, std::shared_ptr<void> owner);
+	LifeGrid(const LifeGrid& other);
+	LifeGrid& operator=(const LifeGrid& other);
+	LifeGrid(LifeGrid&&) = default;
+	LifeGrid& operator=(LifeGrid&&) = default;
+	void own_words(); // copy the words of an owner into the grid's own memory and let go of it, nothing if there is none
+
+	bool get(int x, int y) const;
+	void set(int x, int y, bool alive);
+	void clear(); // all cells (and halo) dead
+
+	// fill the halo from the cells for this boundary, once before stepping from this grid
+	void refresh_halo(Boundary boundary);
+	// just the halo columns of rows [y_begin, y_end), for stepping rows that aren't the whole grid
+	void refresh_halo_columns(Boundary boundary, int y_begin, int y_end);
+	// back to all dead halo and nothing past the width, so the grid can be read (and overwritten) as just cells
+	void clear_halo();
+
+	uint64_t population() const; // live cells
+	static int popcount(uint64_t word);
+
+	// 64 bit hash of the cells (not the halo), the XOR of word_hash over all cell words.
+	// so changing one word changes the hash by word_hash(old) ^ word_hash(new), and salt keeps grids that are hashed together apart
+	uint64_t hash(uint64_t salt = 0) const;
+	uint64_t word_hash(int w, int y, uint64_t salt = 0) const; // of word w in row y
+	static uint64_t word_hash(uint64_t word, uint64_t index);
+
+	int width() const { return m_width; }
+	int height() const { return m_height; }
+	int words_per_row() const { return m_words_per_row; }
+	// mask of the bits in the last word of a row that are real cells
+	uint64_t tail_mask() const { return m_tail_mask; }
+
+	// pointer to the first cell word of row y, valid for y in [-1, height], and [-1, words_per_row] as index
+	uint64_t* row(int y) { return &m_data[(y + 1) * m_stride + 1]; }
+	const uint64_t* row(int y) const { return &m_data[(y + 1) * m_stride + 1]; }
+	// all of the words, halo included, starting with row(-1)[-1]
+	const uint64_t* words() const { return m_data; }
+	size_t word_count() const { return size_t(m_stride) * (m_height + 2); }
+
+private:
+	void set_size(int width, int height);
+
+	int m_width;
+	int m_height;
+	int m_words_per_row; // words with cells in them
+	int m_stride; // m_words_per_row + 2 halo words
+	uint64_t m_tail_mask;
+	std::vector<uint64_t> m_words; // unless the words belong to m_owner
+	std::shared_ptr<void> m_owner;
+	uint64_t* m_data; // m_words.data() or the memory of m_owner
+};
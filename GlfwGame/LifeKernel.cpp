@@ -0,0 +1,171 @@
+#include "LifeKernel.h"
+#include "LifeKernelRow.h"
+#include "LifeGrid.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+#if LIFE_KERNEL_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace
+{
+#if LIFE_KERNEL_X86
+    void cpuid(int leaf, int subleaf, unsigned int regs[4]) // eax, ebx, ecx, edx
+    {
+#if defined(_MSC_VER)
+        int r[4];
+        __cpuidex(r, leaf, subleaf);
+        for (int i = 0; i < 4; ++i) regs[i] = (unsigned int)r[i];
+#else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    uint64_t xgetbv0() // which register states the os saves on context switches
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned int lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return (uint64_t(hi) << 32) | lo;
+#endif
+    }
+#endif
+
+    LifeKernel::RowFunction row_function_for(LifeKernel::Isa isa, bool conway)
+    {
+        switch (isa) {
+#if LIFE_KERNEL_X86
+        case LifeKernel::Isa::SSE2: return conway ? LifeKernel::row_sse2 : LifeKernel::row_sse2_rule;
+        case LifeKernel::Isa::AVX2: return conway ? LifeKernel::row_avx2 : LifeKernel::row_avx2_rule;
+        case LifeKernel::Isa::AVX512: return conway ? LifeKernel::row_avx512 : LifeKernel::row_avx512_rule;
+#endif
+        default: return conway ? LifeKernel::row_scalar : LifeKernel::row_scalar_rule;
+        }
+    }
+
+    // picked once at startup
+    LifeKernel::Isa s_isa = LifeKernel::detect_isa();
+    LifeKernel::RowFunction s_conway_row_function = row_function_for(s_isa, true);
+    LifeKernel::RowFunction s_rule_row_function = row_function_for(s_isa, false);
+}
+
+void LifeKernel::row_scalar(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule&)
+{
+    step_row<ScalarOps>(up, mid, down, out, words);
+}
+
+void LifeKernel::row_scalar_rule(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule)
+{
+    step_row_rule<ScalarOps>(up, mid, down, out, words, rule.birth, rule.survive);
+}
+
+LifeKernel::Isa LifeKernel::detect_isa()
+{
+#if LIFE_KERNEL_X86
+    unsigned int r[4];
+    cpuid(0, 0, r);
+    const unsigned int max_leaf = r[0];
+
+    cpuid(1, 0, r);
+    const bool sse2 = (r[3] >> 26) & 1;
+    const bool osxsave = (r[2] >> 27) & 1;
+    const bool avx = (r[2] >> 28) & 1;
+
+    bool avx2 = false, avx512 = false;
+    if (max_leaf >= 7 && osxsave && avx) {
+        const uint64_t xcr0 = xgetbv0();
+        const bool os_ymm = (xcr0 & 0x6) == 0x6; // xmm and ymm state
+        const bool os_zmm = (xcr0 & 0xe6) == 0xe6; // and opmask, zmm 0-15 and zmm 16-31 state
+        cpuid(7, 0, r);
+        avx2 = os_ymm && ((r[1] >> 5) & 1);
+        avx512 = os_zmm && ((r[1] >> 16) & 1); // AVX-512 F is all the kernel needs
+    }
+
+    if (avx512) return Isa::AVX512;
+    if (avx2) return Isa::AVX2;
+    if (sse2) return Isa::SSE2;
+#endif
+    return Isa::Scalar;
+}
+
+bool LifeKernel::has_popcnt()
+{
+#if LIFE_KERNEL_X86
+    unsigned int r[4];
+    cpuid(1, 0, r);
+    return (r[2] >> 23) & 1;
+#else
+    return false;
+#endif
+}
+
+LifeKernel::Isa LifeKernel::isa()
+{
+    return s_isa;
+}
+
+void LifeKernel::set_isa(Isa isa)
+{
+    if ((int)isa > (int)detect_isa()) {
+        isa = Isa::Scalar;
+    }
+    s_isa = isa;
+    s_conway_row_function = row_function_for(isa, true);
+    s_rule_row_function = row_function_for(isa, false);
+}
+
+LifeKernel::RowFunction LifeKernel::row_function(const Rule& rule)
+{
+    return rule.is_conway() ? s_conway_row_function : s_rule_row_function;
+}
+
+const char* LifeKernel::isa_name(Isa isa)
+{
+    switch (isa) {
+    case Isa::SSE2: return "SSE2";
+    case Isa::AVX2: return "AVX2";
+    case Isa::AVX512: return "AVX-512";
+    default: return "Scalar";
+    }
+}
+
+void LifeKernel::step_rows(const LifeGrid& src, LifeGrid& dst, int y_begin, int y_end, const Rule& rule)
+{
+    const int words = src.words_per_row();
+    const uint64_t tail_mask = src.tail_mask();
+    const RowFunction step_row = row_function(rule);
+
+    for (int y = y_begin; y < y_end; ++y) {
+        uint64_t* out = dst.row(y);
+        step_row(src.row(y - 1), src.row(y), src.row(y + 1), out, words, rule);
+        out[words - 1] &= tail_mask;
+    }
+}
+
+void LifeKernel::step_rows_parallel(const LifeGrid& src, LifeGrid& dst, int y_begin, int y_end, const Rule& rule, ThreadPool& pool)
+{
+    constexpr int MIN_WORDS_PER_BAND = 4096; // smaller bands cost more in waking threads than they save
+    const int rows = y_end - y_begin;
+    const long long total_words = (long long)rows * src.words_per_row();
+
+    // a few bands per thread, so one slow thread doesn't hold up the rest
+    const int bands = (int)std::max(1LL, std::min({ (long long)pool.thread_count() * 4, total_words / MIN_WORDS_PER_BAND, (long long)rows }));
+    if (bands == 1) {
+        step_rows(src, dst, y_begin, y_end, rule);
+        return;
+    }
+
+    pool.run(bands, [&](int band) {
+        const int band_begin = y_begin + (int)((long long)rows * band / bands);
+        const int band_end = y_begin + (int)((long long)rows * (band + 1) / bands);
+        step_rows(src, dst, band_begin, band_end, rule);
+    });
+}
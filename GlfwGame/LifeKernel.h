@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Rule.h"
+
+class LifeGrid;
+class ThreadPool;
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define LIFE_KERNEL_X86 1
+#else
+#define LIFE_KERNEL_X86 0
+#endif
+
+// Game of life kernels working on the packed rows of LifeGrid.
+// The widest instruction set the cpu (and os) supports is picked at startup, all of them give bit identical results.
+// Every instruction set has two kernels: B3/S23 with the rule built in, and one that follows any Rule
+namespace LifeKernel
+{
+	enum class Isa { Scalar, SSE2, AVX2, AVX512 };
+
+	// step one row: up, mid and down point at the first word of their rows (index -1 and words are the halo).
+	// the B3/S23 kernels ignore rule
+	using RowFunction = void (*)(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule);
+
+	void row_scalar(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule);
+	void row_scalar_rule(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule);
+#if LIFE_KERNEL_X86
+	void row_sse2(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule);
+	void row_sse2_rule(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule);
+	void row_avx2(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule);
+	void row_avx2_rule(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule);
+	void row_avx512(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule);
+	void row_avx512_rule(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule);
+#endif
+
+	Isa detect_isa(); // best instruction set supported, from CPUID
+	bool has_popcnt(); // the POPCNT instruction, also from CPUID
+	Isa isa(); // the one in use
+	void set_isa(Isa isa); // override, for comparing kernels. Falls back to Scalar if not supported
+	const char* isa_name(Isa isa);
+	RowFunction row_function(const Rule& rule); // for the isa in use, the B3/S23 one if rule is B3/S23
+
+	// rule on rows [y_begin, y_end) of src, written to the same rows of dst.
+	// reads the halo of src, bits past the width are cleared in dst
+	void step_rows(const LifeGrid& src, LifeGrid& dst, int y_begin, int y_end, const Rule& rule);
+
+	// same result as step_rows, but the rows are split into horizontal bands that the threads of pool step at the same time.
+	// every band only writes its own rows of dst, so it doesn't matter which thread does which band
+	void step_rows_parallel(const LifeGrid& src, LifeGrid& dst, int y_begin, int y_end, const Rule& rule, ThreadPool& pool);
+}
@@ -0,0 +1,55 @@
+// AVX2 version of the row kernels, the only file allowed to use AVX2 instructions
+#include "LifeKernel.h"
+
+#if LIFE_KERNEL_X86
+
+#include <immintrin.h>
+
+// everything from here on may use AVX2
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("avx2")
+#endif
+
+#include "LifeKernelRow.h"
+
+namespace
+{
+    struct AVX2Ops
+    {
+        using type = __m256i;
+        static constexpr int lanes = 4;
+
+        static type load(const uint64_t* p) { return _mm256_loadu_si256((const type*)p); }
+        static void store(uint64_t* p, type v) { _mm256_storeu_si256((type*)p, v); }
+        static type and_(type a, type b) { return _mm256_and_si256(a, b); }
+        static type or_(type a, type b) { return _mm256_or_si256(a, b); }
+        static type xor_(type a, type b) { return _mm256_xor_si256(a, b); }
+        static type andnot(type a, type b) { return _mm256_andnot_si256(a, b); }
+        static type not_(type a) { return _mm256_xor_si256(a, _mm256_set1_epi32(-1)); }
+        static type zero() { return _mm256_setzero_si256(); }
+        static type xor3(type a, type b, type c) { return xor_(xor_(a, b), c); }
+        static type majority(type a, type b, type c) { return or_(and_(a, b), and_(xor_(a, b), c)); }
+        static type shl1(type a) { return _mm256_slli_epi64(a, 1); }
+        static type shr1(type a) { return _mm256_srli_epi64(a, 1); }
+        static type shl63(type a) { return _mm256_slli_epi64(a, 63); }
+        static type shr63(type a) { return _mm256_srli_epi64(a, 63); }
+    };
+}
+
+void LifeKernel::row_avx2(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule&)
+{
+    step_row<AVX2Ops>(up, mid, down, out, words);
+}
+
+void LifeKernel::row_avx2_rule(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule)
+{
+    step_row_rule<AVX2Ops>(up, mid, down, out, words, rule.birth, rule.survive);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#endif
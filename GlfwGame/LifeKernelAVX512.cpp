@@ -0,0 +1,55 @@
+// AVX-512 version of the row kernels, the only file allowed to use AVX-512 instructions
+#include "LifeKernel.h"
+
+#if LIFE_KERNEL_X86
+
+#include <immintrin.h>
+
+// everything from here on may use AVX-512
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("avx512f")
+#endif
+
+#include "LifeKernelRow.h"
+
+namespace
+{
+    struct AVX512Ops
+    {
+        using type = __m512i;
+        static constexpr int lanes = 8;
+
+        static type load(const uint64_t* p) { return _mm512_loadu_si512((const type*)p); }
+        static void store(uint64_t* p, type v) { _mm512_storeu_si512((type*)p, v); }
+        static type and_(type a, type b) { return _mm512_and_si512(a, b); }
+        static type or_(type a, type b) { return _mm512_or_si512(a, b); }
+        static type xor_(type a, type b) { return _mm512_xor_si512(a, b); }
+        static type andnot(type a, type b) { return _mm512_andnot_si512(a, b); }
+        static type not_(type a) { return _mm512_ternarylogic_epi64(a, a, a, 0x55); }
+        static type zero() { return _mm512_setzero_si512(); }
+        static type xor3(type a, type b, type c) { return _mm512_ternarylogic_epi64(a, b, c, 0x96); }
+        static type majority(type a, type b, type c) { return _mm512_ternarylogic_epi64(a, b, c, 0xe8); }
+        static type shl1(type a) { return _mm512_slli_epi64(a, 1); }
+        static type shr1(type a) { return _mm512_srli_epi64(a, 1); }
+        static type shl63(type a) { return _mm512_slli_epi64(a, 63); }
+        static type shr63(type a) { return _mm512_srli_epi64(a, 63); }
+    };
+}
+
+void LifeKernel::row_avx512(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule&)
+{
+    step_row<AVX512Ops>(up, mid, down, out, words);
+}
+
+void LifeKernel::row_avx512_rule(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule)
+{
+    step_row_rule<AVX512Ops>(up, mid, down, out, words, rule.birth, rule.survive);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#endif
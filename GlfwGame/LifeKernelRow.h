@@ -0,0 +1,140 @@
+#pragma once
+
+// The row kernels written once for any vector width: B3/S23, and any other Life-like rule.
+// Only included by the LifeKernel*.cpp files, each one instantiates it with the ops of its own instruction set,
+// everything in here has internal linkage so the different instruction sets never mix.
+
+#include <cstdint>
+
+namespace
+{
+	// ops for one uint64_t at a time, also used for the words left over at the end of a row
+	struct ScalarOps
+	{
+		using type = uint64_t;
+		static constexpr int lanes = 1;
+
+		static type load(const uint64_t* p) { return *p; }
+		static void store(uint64_t* p, type v) { *p = v; }
+		static type and_(type a, type b) { return a & b; }
+		static type or_(type a, type b) { return a | b; }
+		static type xor_(type a, type b) { return a ^ b; }
+		static type andnot(type a, type b) { return ~a & b; } // (NOT a) AND b, like the SSE instruction
+		static type not_(type a) { return ~a; }
+		static type zero() { return 0; }
+		static type xor3(type a, type b, type c) { return a ^ b ^ c; }
+		static type majority(type a, type b, type c) { return (a & b) | ((a ^ b) & c); }
+		static type shl1(type a) { return a << 1; }
+		static type shr1(type a) { return a >> 1; }
+		static type shl63(type a) { return a << 63; }
+		static type shr63(type a) { return a >> 63; }
+	};
+
+	// the 8 neighbor counts of V::lanes words starting at mid[0], as bit planes: n = 8 * eights + 4 * fours + 2 * twos + ones.
+	// fours_or_more is what B3/S23 needs, without the last adder
+	template <class V>
+	struct NeighborCount
+	{
+		using T = typename V::type;
+		T ones, twos, c4, c5; // c4 and c5 are both worth 4
+
+		NeighborCount(const uint64_t* up, const uint64_t* mid, const uint64_t* down)
+		{
+			// neighbor to the west of bit i is bit i-1, so shift left and carry in the top bit of the previous word,
+			// the previous word of every lane is just an unaligned load one word earlier
+			const T u = V::load(up), d = V::load(down), m = V::load(mid);
+			const T n0 = V::or_(V::shl1(u), V::shr63(V::load(up - 1)));
+			const T n1 = u;
+			const T n2 = V::or_(V::shr1(u), V::shl63(V::load(up + 1)));
+			const T n3 = V::or_(V::shl1(m), V::shr63(V::load(mid - 1)));
+			const T n4 = V::or_(V::shr1(m), V::shl63(V::load(mid + 1)));
+			const T n5 = V::or_(V::shl1(d), V::shr63(V::load(down - 1)));
+			const T n6 = d;
+			const T n7 = V::or_(V::shr1(d), V::shl63(V::load(down + 1)));
+
+			// sum the 8 neighbor bits with full adders (sum = xor3, carry = majority)
+			const T s0 = V::xor3(n0, n1, n2), c0 = V::majority(n0, n1, n2);
+			const T s1 = V::xor3(n3, n4, n5), c1 = V::majority(n3, n4, n5);
+			const T s2 = V::xor_(n6, n7), c2 = V::and_(n6, n7);
+
+			ones = V::xor3(s0, s1, s2);
+			const T c3 = V::majority(s0, s1, s2);
+
+			const T t0 = V::xor3(c0, c1, c2);
+			c4 = V::majority(c0, c1, c2);
+			twos = V::xor_(t0, c3);
+			c5 = V::and_(t0, c3);
+		}
+
+		T fours_or_more() const { return V::or_(c4, c5); }
+		T fours() const { return V::xor_(c4, c5); }
+		T eights() const { return V::and_(c4, c5); } // 8 neighbors, the other planes are 0 then
+	};
+
+	// next state of the V::lanes words starting at mid[0], B3/S23
+	template <class V>
+	inline typename V::type step_words(const uint64_t* up, const uint64_t* mid, const uint64_t* down)
+	{
+		const NeighborCount<V> n(up, mid, down);
+
+		// alive with 3 neighbors, or 2 neighbors if already alive. 4 or more is dead either way
+		return V::andnot(n.fours_or_more(), V::and_(n.twos, V::or_(n.ones, V::load(mid))));
+	}
+
+	// next state for any rule: birth and survive have bit n set if n neighbors give a live cell (see Rule).
+	// one equality mask per neighbor count the rule cares about, the branches go the same way for the whole run
+	template <class V>
+	inline typename V::type step_words_rule(const uint64_t* up, const uint64_t* mid, const uint64_t* down, unsigned birth, unsigned survive)
+	{
+		using T = typename V::type;
+		const NeighborCount<V> n(up, mid, down);
+		const T fours = n.fours(), eights = n.eights();
+		const T planes[3] = { n.ones, n.twos, fours };
+		const T not_planes[3] = { V::not_(n.ones), V::not_(n.twos), V::not_(fours) };
+
+		T born = V::zero(), stays = V::zero();
+		const unsigned counts = birth | survive;
+		for (int c = 0; c <= 8; ++c) {
+			if (!((counts >> c) & 1)) continue;
+			T equal;
+			if (c == 8) {
+				equal = eights;
+			}
+			else {
+				equal = V::andnot(eights, V::and_(V::and_(
+					(c & 1) ? planes[0] : not_planes[0],
+					(c & 2) ? planes[1] : not_planes[1]),
+					(c & 4) ? planes[2] : not_planes[2]));
+			}
+			if ((birth >> c) & 1) born = V::or_(born, equal);
+			if ((survive >> c) & 1) stays = V::or_(stays, equal);
+		}
+
+		const T m = V::load(mid);
+		return V::or_(V::andnot(m, born), V::and_(m, stays));
+	}
+
+	template <class V>
+	inline void step_row(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words)
+	{
+		int i = 0;
+		for (; i + V::lanes <= words; i += V::lanes) {
+			V::store(out + i, step_words<V>(up + i, mid + i, down + i));
+		}
+		for (; i < words; ++i) {
+			out[i] = step_words<ScalarOps>(up + i, mid + i, down + i);
+		}
+	}
+
+	template <class V>
+	inline void step_row_rule(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, unsigned birth, unsigned survive)
+	{
+		int i = 0;
+		for (; i + V::lanes <= words; i += V::lanes) {
+			V::store(out + i, step_words_rule<V>(up + i, mid + i, down + i, birth, survive));
+		}
+		for (; i < words; ++i) {
+			out[i] = step_words_rule<ScalarOps>(up + i, mid + i, down + i, birth, survive);
+		}
+	}
+}
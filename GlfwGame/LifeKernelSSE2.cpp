@@ -0,0 +1,55 @@
+// SSE2 version of the row kernels, the only file allowed to use SSE2 instructions
+#include "LifeKernel.h"
+
+#if LIFE_KERNEL_X86
+
+#include <immintrin.h>
+
+// everything from here on may use SSE2
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("sse2")
+#endif
+
+#include "LifeKernelRow.h"
+
+namespace
+{
+    struct SSE2Ops
+    {
+        using type = __m128i;
+        static constexpr int lanes = 2;
+
+        static type load(const uint64_t* p) { return _mm_loadu_si128((const type*)p); }
+        static void store(uint64_t* p, type v) { _mm_storeu_si128((type*)p, v); }
+        static type and_(type a, type b) { return _mm_and_si128(a, b); }
+        static type or_(type a, type b) { return _mm_or_si128(a, b); }
+        static type xor_(type a, type b) { return _mm_xor_si128(a, b); }
+        static type andnot(type a, type b) { return _mm_andnot_si128(a, b); }
+        static type not_(type a) { return _mm_xor_si128(a, _mm_set1_epi32(-1)); }
+        static type zero() { return _mm_setzero_si128(); }
+        static type xor3(type a, type b, type c) { return xor_(xor_(a, b), c); }
+        static type majority(type a, type b, type c) { return or_(and_(a, b), and_(xor_(a, b), c)); }
+        static type shl1(type a) { return _mm_slli_epi64(a, 1); }
+        static type shr1(type a) { return _mm_srli_epi64(a, 1); }
+        static type shl63(type a) { return _mm_slli_epi64(a, 63); }
+        static type shr63(type a) { return _mm_srli_epi64(a, 63); }
+    };
+}
+
+void LifeKernel::row_sse2(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule&)
+{
+    step_row<SSE2Ops>(up, mid, down, out, words);
+}
+
+void LifeKernel::row_sse2_rule(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out, int words, const Rule& rule)
+{
+    step_row_rule<SSE2Ops>(up, mid, down, out, words, rule.birth, rule.survive);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#endif
@@ -0,0 +1,198 @@
+#include "LifeStats.h"
+#include "LifeGrid.h"
+#include "LifeKernel.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// count_block has to end up inside count_block_popcnt for that one to use the instruction
+#if defined(_MSC_VER)
+#define LIFE_STATS_INLINE __forceinline
+#else
+#define LIFE_STATS_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace
+{
+    LIFE_STATS_INLINE int popcount(uint64_t word)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        return (int)__popcnt64(word);
+#elif defined(_MSC_VER)
+        return LifeGrid::popcount(word);
+#else
+        return __builtin_popcountll(word);
+#endif
+    }
+
+    int count_trailing_zeros(uint64_t word) // word != 0
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return (int)index;
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    int count_leading_zeros(uint64_t word) // word != 0
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, word);
+        return 63 - (int)index;
+#else
+        return __builtin_clzll(word);
+#endif
+    }
+
+    // what a block of words adds up to, with the words of its rows or'ed together for the box
+    struct BlockCount
+    {
+        uint64_t population = 0, births = 0;
+        int first_row = -1, last_row = -1; // with live cells
+    };
+
+    LIFE_STATS_INLINE void count_block(const LifeGrid* before, const LifeGrid& after, int begin, int end, int y_begin, int y_end,
+        BlockCount& c, uint64_t* columns)
+    {
+        // sums in locals, the compiler can't tell that columns doesn't point at c
+        const int last = end - 1;
+        const uint64_t last_mask = end == after.words_per_row() ? after.tail_mask() : ~uint64_t(0);
+        uint64_t births = 0;
+        for (int y = y_begin; y < y_end; ++y) {
+            const uint64_t* a = after.row(y);
+            uint64_t population = 0;
+            if (before) {
+                const uint64_t* b = before->row(y);
+                for (int w = begin; w < last; ++w) {
+                    population += popcount(a[w]);
+                    births += popcount(a[w] & ~b[w]);
+                    columns[w - begin] |= a[w];
+                }
+                const uint64_t a_last = a[last] & last_mask, b_last = b[last] & last_mask;
+                population += popcount(a_last);
+                births += popcount(a_last & ~b_last);
+                columns[last - begin] |= a_last;
+            }
+            else {
+                for (int w = begin; w < last; ++w) {
+                    population += popcount(a[w]);
+                    columns[w - begin] |= a[w];
+                }
+                population += popcount(a[last] & last_mask);
+                columns[last - begin] |= a[last] & last_mask;
+            }
+            if (population) {
+                if (c.first_row < 0) c.first_row = y;
+                c.last_row = y;
+                c.population += population;
+            }
+        }
+        c.births = births;
+    }
+
+    using BlockCounter = void (*)(const LifeGrid*, const LifeGrid&, int, int, int, int, BlockCount&, uint64_t*);
+
+    void count_block_portable(const LifeGrid* before, const LifeGrid& after, int begin, int end, int y_begin, int y_end,
+        BlockCount& c, uint64_t* columns)
+    {
+        count_block(before, after, begin, end, y_begin, y_end, c, columns);
+    }
+
+    // gcc and clang only use the POPCNT instruction where they are told that it's there,
+    // msvc always does (and so does LifeGrid::popcount)
+#if LIFE_KERNEL_X86 && (defined(__GNUC__) || defined(__clang__))
+    __attribute__((target("popcnt")))
+    void count_block_popcnt(const LifeGrid* before, const LifeGrid& after, int begin, int end, int y_begin, int y_end,
+        BlockCount& c, uint64_t* columns)
+    {
+        count_block(before, after, begin, end, y_begin, y_end, c, columns);
+    }
+
+    const BlockCounter s_count_block = LifeKernel::has_popcnt() ? count_block_popcnt : count_block_portable; // picked once at startup
+#else
+    const BlockCounter s_count_block = count_block_portable;
+#endif
+}
+
+void LifeStats::add_block(const LifeGrid* before, const LifeGrid& after, int begin, int end, int y_begin, int y_end)
+{
+    // a tile fits on the stack, whole rows don't
+    uint64_t stack_columns[16] = {};
+    std::vector<uint64_t> heap_columns;
+    uint64_t* columns = stack_columns;
+    if (end - begin > 16) {
+        heap_columns.assign(end - begin, 0);
+        columns = heap_columns.data();
+    }
+
+    BlockCount c;
+    s_count_block(before, after, begin, end, y_begin, y_end, c, columns);
+    population += c.population;
+    births += c.births;
+    if (c.population == 0) return;
+
+    int first = 0, last = end - begin - 1; // columns with live cells
+    while (columns[first] == 0) ++first;
+    while (columns[last] == 0) --last;
+    LifeStats box;
+    box.min_x = (begin + first) * 64 + count_trailing_zeros(columns[first]);
+    box.max_x = (begin + last) * 64 + 63 - count_leading_zeros(columns[last]);
+    box.min_y = c.first_row;
+    box.max_y = c.last_row;
+    add(box);
+}
+
+void LifeStats::set_deaths(uint64_t population_before)
+{
+    deaths = births + population_before - population;
+}
+
+void LifeStats::add(const LifeStats& other)
+{
+    population += other.population;
+    births += other.births;
+    deaths += other.deaths;
+    if (other.empty()) return;
+    if (empty()) {
+        min_x = other.min_x; max_x = other.max_x;
+        min_y = other.min_y; max_y = other.max_y;
+        return;
+    }
+    min_x = std::min(min_x, other.min_x);
+    max_x = std::max(max_x, other.max_x);
+    min_y = std::min(min_y, other.min_y);
+    max_y = std::max(max_y, other.max_y);
+}
+
+void LifeStats::add_cell(int x, int y)
+{
+    LifeStats cell;
+    cell.population = 1;
+    cell.min_x = cell.max_x = x;
+    cell.min_y = cell.max_y = y;
+    add(cell);
+}
+
+LifeStats LifeStats::count(const LifeGrid* before, const LifeGrid& after, ThreadPool& pool)
+{
+    constexpr int ROWS_PER_TASK = 64;
+    const int tasks = (after.height() + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    std::vector<LifeStats> parts(tasks);
+    pool.run(tasks, [&](int task) {
+        const int y_end = std::min(after.height(), (task + 1) * ROWS_PER_TASK);
+        parts[task].add_block(before, after, 0, after.words_per_row(), task * ROWS_PER_TASK, y_end);
+    });
+    LifeStats stats;
+    for (const LifeStats& part : parts) {
+        stats.add(part);
+    }
+    return stats;
+}
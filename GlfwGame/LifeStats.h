@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+class LifeGrid;
+class ThreadPool;
+
+// Population, births, deaths and the box around the live cells of one generation, counted with popcount
+// a word at a time (the POPCNT instruction where the cpu has it). ActiveTiles counts every tile right after
+// stepping it, while it is in the cache, everything else that steps takes one pass over the new generation and the one before.
+// Deaths aren't counted, they follow from the births and the population before
+struct LifeStats
+{
+	uint64_t generation = 0;
+	uint64_t population = 0;
+	uint64_t births = 0; // cells that came alive in the last step (more than one generation with HashLife)
+	uint64_t deaths = 0;
+	int min_x = 0, min_y = 0, max_x = -1, max_y = -1; // box around the live cells, max_x < min_x if there are none
+
+	bool empty() const { return max_x < min_x; }
+
+	// words [begin, end) of rows [y_begin, y_end) of after, stepped from before (null: no births).
+	// bits past the width don't count
+	void add_block(const LifeGrid* before, const LifeGrid& after, int begin, int end, int y_begin, int y_end);
+	void set_deaths(uint64_t population_before); // once all the births are in
+	void add(const LifeStats& other); // of other cells of the same generation
+	void add_cell(int x, int y); // one more live cell
+
+	// all of after, stepped from before (null: it wasn't), in bands on the threads of pool. without the deaths
+	static LifeStats count(const LifeGrid* before, const LifeGrid& after, ThreadPool& pool);
+};
@@ -0,0 +1,80 @@
+#include "LookupLife.h"
+#include "LifeGrid.h"
+#include "Rule.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+LookupLife::LookupLife()
+{
+    set_rule(Rule());
+}
+
+void LookupLife::set_rule(const Rule& rule)
+{
+    m_table.assign(1 << 16, 0);
+    for (int index = 0; index < (1 << 16); ++index) {
+        auto cell = [index](int x, int y) { return (index >> (y * 4 + x)) & 1; }; // x, y in [0, 4)
+        uint8_t entry = 0;
+        for (int i = 0; i < 4; ++i) {
+            const int x = 1 + (i & 1), y = 1 + (i >> 1);
+            int neighbors = 0;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (dx || dy) neighbors += cell(x + dx, y + dy);
+                }
+            }
+            entry |= uint8_t(rule.next(cell(x, y) != 0, neighbors)) << i;
+        }
+        m_table[index] = entry;
+    }
+}
+
+void LookupLife::step(const LifeGrid& src, LifeGrid& dst, ThreadPool& pool) const
+{
+    constexpr int BLOCK_ROWS_PER_TASK = 16;
+    const int block_rows = (src.height() + 1) / 2;
+    const int tasks = (block_rows + BLOCK_ROWS_PER_TASK - 1) / BLOCK_ROWS_PER_TASK;
+    pool.run(tasks, [&](int task) {
+        const int end = std::min(block_rows, (task + 1) * BLOCK_ROWS_PER_TASK);
+        for (int b = task * BLOCK_ROWS_PER_TASK; b < end; ++b) {
+            step_block_row(src, dst, b * 2);
+        }
+    });
+}
+
+void LookupLife::step_block_row(const LifeGrid& src, LifeGrid& dst, int y) const
+{
+    const int words = src.words_per_row();
+    const bool has_second = y + 1 < src.height(); // not with an odd height on the last block row
+
+    // without a second row, row y + 2 would be past the halo. any row does there, its results aren't written
+    const uint64_t* rows[4] = { src.row(y - 1), src.row(y), src.row(y + 1), src.row(has_second ? y + 2 : y + 1) };
+    uint64_t* out0 = dst.row(y);
+    uint64_t* out1 = has_second ? dst.row(y + 1) : nullptr;
+
+    for (int w = 0; w < words; ++w) {
+        // bit b of shifted is cell 64 * w + b - 1, so the 4 cells of the block at bit b start at bit b.
+        // the last block of the word also needs the cell shifted out, and bit 0 of the next word
+        uint64_t shifted[4], past[4];
+        for (int r = 0; r < 4; ++r) {
+            shifted[r] = (rows[r][w] << 1) | (rows[r][w - 1] >> 63);
+            past[r] = ((rows[r][w] >> 63) << 2) | ((rows[r][w + 1] & 1) << 3);
+        }
+
+        uint64_t word0 = 0, word1 = 0;
+        auto block = [&](int b, uint64_t n0, uint64_t n1, uint64_t n2, uint64_t n3) {
+            const uint64_t entry = m_table[n0 | (n1 << 4) | (n2 << 8) | (n3 << 12)];
+            word0 |= (entry & 3) << b;
+            word1 |= (entry >> 2) << b;
+        };
+        for (int b = 0; b < 62; b += 2) {
+            block(b, (shifted[0] >> b) & 0xF, (shifted[1] >> b) & 0xF, (shifted[2] >> b) & 0xF, (shifted[3] >> b) & 0xF);
+        }
+        block(62, (shifted[0] >> 62) | past[0], (shifted[1] >> 62) | past[1], (shifted[2] >> 62) | past[2], (shifted[3] >> 62) | past[3]);
+        out0[w] = word0;
+        if (out1) out1[w] = word1;
+    }
+    out0[words - 1] &= src.tail_mask();
+    if (out1) out1[words - 1] &= src.tail_mask();
+}
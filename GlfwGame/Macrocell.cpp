@@ -0,0 +1,74 @@
+#include "Macrocell.h"
+#include "Universe.h"
+
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+
+bool MacrocellReader::open(const char* path)
+{
+    m_path = path;
+    m_header = Header();
+    m_file.open(path, std::ios::binary);
+    if (!m_file) {
+        std::cout << "ERROR::FILE_NOT_FOUND: " << path << "\n";
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(m_file, line) || line.compare(0, 4, "[M2]") != 0) {
+        std::cout << "ERROR::MACROCELL: no [M2] line at the start of " << path << "\n";
+        return false;
+    }
+    // # lines until the first node, #R is the rule, the others are comments, the generation and such
+    while (m_file.peek() == '#') {
+        std::getline(m_file, line);
+        if (line.compare(0, 2, "#R") != 0) continue;
+        size_t begin = 2, end = line.size();
+        while (begin < end && line[begin] == ' ') ++begin;
+        while (end > begin && (line[end - 1] == ' ' || line[end - 1] == '\r')) --end;
+        const std::string rule = line.substr(begin, end - begin);
+        if (!Rule::parse(rule.c_str(), m_header.rule)) {
+            std::cout << "ERROR::MACROCELL: unknown rule " << rule << " in " << m_path << "\n";
+            return false;
+        }
+        m_header.has_rule = true;
+    }
+    return true;
+}
+
+bool MacrocellReader::read_nodes(HashLife& tree)
+{
+    if (!tree.read_macrocell(m_file)) {
+        std::cout << "ERROR::MACROCELL: in " << m_path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool write_macrocell(const char* path, const Universe& universe)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cout << "ERROR::FILE: can't write " << path << "\n";
+        return false;
+    }
+    file << "[M2] (GlfwGame)\n"
+         << "#R " << universe.rule().to_string() << "\n"
+         << "#G " << universe.generation() << "\n";
+
+    if (universe.engine() == Universe::Engine::HashLife) {
+        universe.hashlife().write_macrocell(file);
+    }
+    else {
+        HashLife tree;
+        tree.load(universe.grid());
+        tree.write_macrocell(file);
+    }
+    if (!file) {
+        std::cout << "ERROR::FILE: can't write " << path << "\n";
+        return false;
+    }
+    return true;
+}
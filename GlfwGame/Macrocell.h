@@ -0,0 +1,41 @@
+#pragma once
+
+#include <fstream>
+
+#include "HashLife.h"
+#include "Rule.h"
+
+class Universe;
+
+// Patterns in Golly's Macrocell format, the HashLife tree itself:
+//   [M2] (golly 4.2)
+//   #R B3/S23
+//   .**$*$       an 8x8 leaf, rows of . and * top row first, each ended by $
+//   4 1 0 0 1    a node of level 4 (16x16): the line numbers of its nw, ne, sw and se children, 0 for empty
+// every distinct node is written once and the last one is the root, so a pattern of repeated structure
+// loads in time proportional to its number of distinct nodes, however big it is (see HashLife::read_macrocell).
+// 2 state rules only
+class MacrocellReader
+{
+public:
+	struct Header {
+		Rule rule;
+		bool has_rule = false; // #R was in the header
+	};
+
+	// opens the file and reads the [M2] line and the # lines, prints an error and returns false if that fails
+	bool open(const char* path);
+	const Header& header() const { return m_header; }
+
+	// the nodes into tree, replacing what was in it. returns false and leaves tree as it was if the file is broken
+	bool read_nodes(HashLife& tree);
+
+private:
+	std::ifstream m_file;
+	Header m_header;
+	const char* m_path = "";
+};
+
+// the whole universe to path: with the HashLife engine everything it has, else the grid, centered.
+// prints an error and returns false if the file can't be written
+bool write_macrocell(const char* path, const Universe& universe);
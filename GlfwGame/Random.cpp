@@ -0,0 +1,83 @@
+#include "Random.h"
+#include "LifeGrid.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr int FRACTION_BITS = 16;
+    constexpr uint32_t ONE = uint32_t(1) << FRACTION_BITS;
+
+    uint64_t mix(uint64_t z) // the SplitMix64 finalizer
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint32_t to_fraction(double density)
+    {
+        if (!(density > 0.0)) return 0;
+        if (density >= 1.0) return ONE;
+        return (uint32_t)std::lround(density * ONE);
+    }
+}
+
+Random::Random(uint64_t seed)
+    : m_seed(seed), m_key(mix(seed ^ 0x6A09E667F3BCC909ull))
+{
+}
+
+uint64_t Random::operator()(uint64_t n) const
+{
+    return mix(m_key + (n + 1) * 0x9E3779B97F4A7C15ull);
+}
+
+uint64_t Random::bits(uint64_t n, double density) const
+{
+    const uint32_t fraction = to_fraction(density);
+    if (fraction == 0) return 0;
+    if (fraction == ONE) return ~uint64_t(0);
+    return bits(n, fraction);
+}
+
+uint64_t Random::bits(uint64_t n, uint32_t fraction) const
+{
+    // from the lowest bit of the fraction up: a 1 ors in a random word, a 0 ands one in, which makes each bit
+    // 1 with probability (p + 1) / 2 or p / 2. one random word for a density of 1/2, FRACTION_BITS at most
+    uint64_t word = 0;
+    for (int i = 0; i < FRACTION_BITS; ++i) {
+        if (word == 0 && !((fraction >> i) & 1)) continue; // and'ing into nothing
+        const uint64_t r = (*this)(n * FRACTION_BITS + i);
+        word = ((fraction >> i) & 1) ? word | r : word & r;
+    }
+    return word;
+}
+
+void Random::fill(LifeGrid& grid, double density, ThreadPool* pool) const
+{
+    constexpr int ROWS_PER_TASK = 64;
+    const uint32_t fraction = to_fraction(density);
+    const int words = grid.words_per_row();
+    auto fill_rows = [&](int y_begin, int y_end) {
+        for (int y = y_begin; y < y_end; ++y) {
+            uint64_t* row = grid.row(y);
+            for (int w = 0; w < words; ++w) {
+                const uint64_t n = uint64_t(y) * words + w;
+                row[w] = fraction == 0 ? 0 : fraction == ONE ? ~uint64_t(0) : bits(n, fraction);
+            }
+            row[words - 1] &= grid.tail_mask();
+        }
+    };
+
+    if (!pool) {
+        fill_rows(0, grid.height());
+        return;
+    }
+    const int tasks = (grid.height() + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    pool->run(tasks, [&](int task) {
+        fill_rows(task * ROWS_PER_TASK, std::min(grid.height(), (task + 1) * ROWS_PER_TASK));
+    });
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+class LifeGrid;
+class ThreadPool;
+
+// Counter-based random numbers: number n of a seed is SplitMix64 of n, keyed with the seed, so there is no state
+// carried from one number to the next. Any part of the sequence can be made on its own, by any thread,
+// and the same seed gives the same numbers on every machine, compiler and thread count (unlike rand())
+class Random
+{
+public:
+	explicit Random(uint64_t seed = 0);
+
+	uint64_t seed() const { return m_seed; }
+	uint64_t operator()(uint64_t n) const; // number n, all 64 bits random
+	// 64 bits for counter n that are each 1 with probability density, which is rounded to 1/65536
+	uint64_t bits(uint64_t n, double density) const;
+
+	// every cell of grid alive with probability density. word w of row y is bits(y * words_per_row + w),
+	// so the soup doesn't depend on how it's split up: in bands of rows on the threads of pool, if there is one
+	void fill(LifeGrid& grid, double density, ThreadPool* pool = nullptr) const;
+
+private:
+	uint64_t bits(uint64_t n, uint32_t fraction) const; // density in 1/65536ths, 0 < fraction < 65536
+
+	uint64_t m_seed;
+	uint64_t m_key; // the seed mixed up, where the counter starts
+};
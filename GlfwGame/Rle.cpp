@@ -0,0 +1,313 @@
+#include "Rle.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    int count_trailing_zeros(uint64_t word) // word != 0
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return (int)index;
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    int count_leading_zeros(uint64_t word) // word != 0
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, word);
+        return 63 - (int)index;
+#else
+        return __builtin_clzll(word);
+#endif
+    }
+
+    uint64_t* row_in(LifeGrid& grid, int y)
+    {
+        return y >= 0 && y < grid.height() ? grid.row(y) : nullptr;
+    }
+
+    // cells [begin, end) of the row alive, whole words at a time
+    void set_run(uint64_t* row, int begin, int end)
+    {
+        const int first = begin >> 6, last = (end - 1) >> 6;
+        const uint64_t first_mask = ~uint64_t(0) << (begin & 63);
+        const uint64_t last_mask = ~uint64_t(0) >> (63 - ((end - 1) & 63));
+        if (first == last) {
+            row[first] |= first_mask & last_mask;
+            return;
+        }
+        row[first] |= first_mask;
+        std::fill(row + first + 1, row + last, ~uint64_t(0));
+        row[last] |= last_mask;
+    }
+
+    // first x in [x, end) whose cell is alive (or dead), end if there is none
+    int next_cell(const uint64_t* row, int x, int end, bool alive)
+    {
+        int w = x >> 6;
+        uint64_t word = (alive ? row[w] : ~row[w]) & (~uint64_t(0) << (x & 63));
+        while (!word) {
+            if (++w * 64 >= end) return end;
+            word = alive ? row[w] : ~row[w];
+        }
+        return std::min(end, w * 64 + count_trailing_zeros(word));
+    }
+
+    // the body of an RLE file: runs like 12o, lines up to 70 characters, through a buffer
+    class RunWriter
+    {
+    public:
+        explicit RunWriter(std::ofstream& file) : m_file(file) {}
+
+        void run(int count, char tag)
+        {
+            char text[16];
+            int length = 0;
+            if (count > 1) {
+                char digits[12];
+                int n = 0;
+                for (; count; count /= 10) digits[n++] = char('0' + count % 10);
+                while (n) text[length++] = digits[--n];
+            }
+            text[length++] = tag;
+            if (m_line + length > LINE_LENGTH) {
+                put('\n');
+                m_line = 0;
+            }
+            for (int i = 0; i < length; ++i) put(text[i]);
+            m_line += length;
+        }
+
+        void end()
+        {
+            put('!');
+            put('\n');
+            m_file.write(m_buffer, m_used);
+            m_used = 0;
+        }
+
+    private:
+        static constexpr int LINE_LENGTH = 70;
+        static constexpr int BUFFER_BYTES = 1 << 16;
+
+        void put(char c)
+        {
+            if (m_used == BUFFER_BYTES) {
+                m_file.write(m_buffer, m_used);
+                m_used = 0;
+            }
+            m_buffer[m_used++] = c;
+        }
+
+        std::ofstream& m_file;
+        char m_buffer[BUFFER_BYTES];
+        int m_used = 0;
+        int m_line = 0;
+    };
+}
+
+bool RleReader::open(const char* path)
+{
+    m_path = path;
+    m_header = Header();
+    m_file.open(path, std::ios::binary);
+    if (!m_file) {
+        std::cout << "ERROR::FILE_NOT_FOUND: " << path << "\n";
+        return false;
+    }
+
+    // comments and empty lines, then the header line
+    int c;
+    while ((c = m_file.peek()) == '#' || c == '\n' || c == '\r') {
+        m_file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    char line[1024];
+    if (!m_file.getline(line, sizeof(line))) {
+        std::cout << "ERROR::RLE: no header line in " << path << "\n";
+        return false;
+    }
+    return parse_header(line);
+}
+
+bool RleReader::parse_header(const char* line)
+{
+    // key = value pairs split by commas, the rule goes to the end of the line and can have commas itself
+    const char* p = line;
+    bool has_x = false, has_y = false;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') ++p;
+        if (*p == '\0' || *p == '\r') break;
+        const char* key = p;
+        while (std::isalpha((unsigned char)*p)) ++p;
+        const size_t key_length = size_t(p - key);
+        while (*p == ' ' || *p == '\t') ++p;
+        if (*p != '=') break;
+        ++p;
+        while (*p == ' ' || *p == '\t') ++p;
+
+        if (key_length == 1 && (*key == 'x' || *key == 'y')) {
+            char* end;
+            const long value = std::strtol(p, &end, 10);
+            if (end == p || value < 0 || value > (1 << 30)) break;
+            (*key == 'x' ? m_header.width : m_header.height) = (int)value;
+            (*key == 'x' ? has_x : has_y) = true;
+            p = end;
+        }
+        else if (key_length == 4 && std::strncmp(key, "rule", 4) == 0) {
+            // Golly adds the bounded grid after a colon, like B3/S23:T100,100
+            char rule[256];
+            size_t length = 0;
+            while (p[length] && p[length] != ':' && p[length] != '\r' && length < sizeof(rule) - 1) {
+                rule[length] = p[length];
+                ++length;
+            }
+            rule[length] = '\0';
+            if (!Rule::parse(rule, m_header.rule)) {
+                std::cout << "ERROR::RLE: unknown rule " << rule << " in " << m_path << "\n";
+                return false;
+            }
+            m_header.has_rule = true;
+            break;
+        }
+        else { // something else, skip the value
+            while (*p && *p != ',') ++p;
+        }
+    }
+    if (!has_x || !has_y) {
+        std::cout << "ERROR::RLE: header has no x = and y = in " << m_path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool RleReader::read_cells(LifeGrid& grid, int left, int top)
+{
+    std::vector<char> buffer(BUFFER_BYTES);
+    long long x = 0, row = 0; // in the pattern
+    long long count = 0; // the number in front of a tag, 0 if none
+    bool comment = false;
+    uint64_t* cells = row_in(grid, top); // of the row being read, nullptr if it's outside the grid
+
+    while (m_file) {
+        m_file.read(buffer.data(), buffer.size());
+        const size_t bytes = (size_t)m_file.gcount();
+        for (size_t i = 0; i < bytes; ++i) {
+            const char c = buffer[i];
+            if (comment) {
+                comment = c != '\n';
+                continue;
+            }
+            if (c >= '0' && c <= '9') {
+                if (count < (1LL << 40)) count = count * 10 + (c - '0');
+                continue;
+            }
+            const long long run = count ? std::min(count, 1LL << 40) : 1;
+            count = 0;
+            switch (c) {
+            case 'b':
+            case '.':
+                x += run;
+                break;
+            case 'o':
+            case 'A':
+                if (cells) {
+                    const long long begin = left + x;
+                    if (run == 1 && begin >= 0 && begin < grid.width()) { // most runs in busy patterns
+                        cells[begin >> 6] |= uint64_t(1) << (begin & 63);
+                    }
+                    else {
+                        const long long end = std::min((long long)grid.width(), begin + run);
+                        if (std::max(0LL, begin) < end) set_run(cells, (int)std::max(0LL, begin), (int)end);
+                    }
+                }
+                x += run;
+                break;
+            case '$':
+                x = 0;
+                row += run;
+                cells = row < (1LL << 31) ? row_in(grid, top - (int)row) : nullptr;
+                break;
+            case '!':
+                return true;
+            case '#': // comment after the pattern started
+                comment = true;
+                break;
+            default:
+                if (c >= 'B' && c <= 'X') { // dying in Generations patterns
+                    x += run;
+                }
+                break; // whitespace and anything else is skipped
+            }
+        }
+    }
+    std::cout << "ERROR::RLE: pattern doesn't end with ! in " << m_path << "\n";
+    return false;
+}
+
+bool write_rle(const char* path, const LifeGrid& grid, const Rule& rule)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cout << "ERROR::FILE: can't write " << path << "\n";
+        return false;
+    }
+
+    // box around the live cells
+    const int words = grid.words_per_row();
+    int min_x = grid.width(), max_x = -1, min_y = grid.height(), max_y = -1;
+    for (int y = 0; y < grid.height(); ++y) {
+        const uint64_t* r = grid.row(y);
+        for (int w = 0; w < words; ++w) {
+            const uint64_t word = r[w] & (w == words - 1 ? grid.tail_mask() : ~uint64_t(0));
+            if (!word) continue;
+            min_x = std::min(min_x, w * 64 + count_trailing_zeros(word));
+            max_x = std::max(max_x, w * 64 + 63 - count_leading_zeros(word));
+            min_y = std::min(min_y, y);
+            max_y = y;
+        }
+    }
+    const bool empty = max_x < 0;
+    file << "x = " << (empty ? 0 : max_x - min_x + 1) << ", y = " << (empty ? 0 : max_y - min_y + 1) << ", rule = " << rule.to_string() << "\n";
+
+    RunWriter out(file);
+    int empty_rows = 0; // row ends that are still to be written, they're merged into one n$
+    for (int y = max_y; y >= min_y && !empty; --y) {
+        const uint64_t* r = grid.row(y);
+        int x = min_x;
+        while (x <= max_x) {
+            const int live = next_cell(r, x, max_x + 1, true);
+            if (live > max_x) break; // the rest of the row is dead, no need to say so
+            if (empty_rows) {
+                out.run(empty_rows, '$');
+                empty_rows = 0;
+            }
+            const int dead = next_cell(r, live, max_x + 1, false);
+            if (live > x) out.run(live - x, 'b');
+            out.run(dead - live, 'o');
+            x = dead;
+        }
+        ++empty_rows;
+    }
+    out.end();
+
+    if (!file) {
+        std::cout << "ERROR::FILE: can't write " << path << "\n";
+        return false;
+    }
+    return true;
+}
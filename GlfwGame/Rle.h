@@ -0,0 +1,47 @@
+#pragma once
+
+#include <fstream>
+
+#include "LifeGrid.h"
+#include "Rule.h"
+
+// Patterns in the RLE format of Golly and the LifeWiki:
+//   #C comment lines
+//   x = 3, y = 3, rule = B3/S23
+//   bo$2bo$3o!
+// runs of dead (b) and live (o) cells, $ ends a row and ! the pattern, a number in front repeats it.
+// Generations patterns have . for dead and A, B .. for the states, only A (alive) is kept.
+// The first row is the top one, so it goes to the highest y (row 0 of the grid is drawn at the bottom).
+// The body is read in blocks straight into the packed words, a run of live cells is a few masked words,
+// so no text is kept around and patterns of hundreds of megabytes load in a fraction of a second
+class RleReader
+{
+public:
+	struct Header {
+		int width = 0;
+		int height = 0;
+		Rule rule;
+		bool has_rule = false; // rule = was in the header
+	};
+
+	// opens the file and reads the comments and the header line, prints an error and returns false if that fails
+	bool open(const char* path);
+	const Header& header() const { return m_header; }
+
+	// the cells of the pattern into grid, with its top left cell at (left, top). cells outside the grid are dropped.
+	// returns false if the pattern is broken off
+	bool read_cells(LifeGrid& grid, int left, int top);
+
+private:
+	static constexpr size_t BUFFER_BYTES = size_t(1) << 20;
+
+	bool parse_header(const char* line);
+
+	std::ifstream m_file;
+	Header m_header;
+	const char* m_path = "";
+};
+
+// the live cells of grid to path in RLE, the box around them with its top row first.
+// dying cells of Generations rules aren't written. prints an error and returns false if the file can't be written
+bool write_rle(const char* path, const LifeGrid& grid, const Rule& rule);
@@ -0,0 +1,166 @@
+#include "Rule.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+    // digits 0-8 until something else, returns where it stopped
+    const char* parse_counts(const char* p, uint16_t& counts)
+    {
+        counts = 0;
+        while (*p >= '0' && *p <= '8') {
+            counts |= 1 << (*p - '0');
+            ++p;
+        }
+        return p;
+    }
+
+    // null if there is no number
+    const char* parse_number(const char* p, int& number)
+    {
+        if (*p < '0' || *p > '9') return nullptr;
+        number = 0;
+        while (*p >= '0' && *p <= '9' && number < 100000) {
+            number = number * 10 + (*p - '0');
+            ++p;
+        }
+        return p;
+    }
+
+    // "a..b" or "a-b"
+    const char* parse_range(const char* p, int& min, int& max)
+    {
+        p = parse_number(p, min);
+        if (!p) return nullptr;
+        if (p[0] == '.' && p[1] == '.') p += 2;
+        else if (*p == '-') ++p;
+        else return nullptr;
+        return parse_number(p, max);
+    }
+
+    // "R5,C0,M1,S34..58,B34..45,NM", the parts in any order, everything but R optional
+    bool parse_larger_than_life(const char* p, Rule& rule)
+    {
+        int radius = 1, states = 2, middle = 0, s_min = 0, s_max = -1, b_min = 0, b_max = -1;
+        while (*p) {
+            const char part = *p++;
+            switch (part) {
+            case 'R': p = parse_number(p, radius); break;
+            case 'C': p = parse_number(p, states); break;
+            case 'M': p = parse_number(p, middle); break;
+            case 'S': p = parse_range(p, s_min, s_max); break;
+            case 'B': p = parse_range(p, b_min, b_max); break;
+            case 'N': if (*p++ != 'M') return false; break; // von Neumann and the others aren't squares
+            default: return false;
+            }
+            if (!p) return false;
+            if (*p == ',') ++p;
+            else if (*p != '\0') return false;
+        }
+
+        if (states < 2) states = 2; // C0 means 2 too
+        if (radius < 1 || radius > Rule::MAX_RADIUS || states > Rule::MAX_STATES || middle > 1) return false;
+        if (middle) { // the live cell itself was counted when surviving
+            --s_min;
+            --s_max;
+        }
+        const int max_count = (2 * radius + 1) * (2 * radius + 1) - 1;
+        s_min = std::max(s_min, 0);
+        s_max = std::min(s_max, max_count);
+        b_min = std::max(b_min, 0);
+        b_max = std::min(b_max, max_count);
+        // an empty range is always 1..0, however it was written (S0..0 with M1 is -1..-1), so it fits the
+        // unsigned fields and to_string gives it back the same
+        if (s_min > s_max) {
+            s_min = 1;
+            s_max = 0;
+        }
+        if (b_min > b_max) {
+            b_min = 1;
+            b_max = 0;
+        }
+
+        Rule parsed;
+        parsed.states = (uint8_t)states;
+        if (radius == 1) { // just a Life-like rule, written without M
+            parsed.birth = parsed.survive = 0;
+            for (int n = b_min; n <= b_max; ++n) parsed.birth |= 1 << n;
+            for (int n = s_min; n <= s_max; ++n) parsed.survive |= 1 << n;
+        }
+        else {
+            parsed.radius = (uint8_t)radius;
+            parsed.middle = middle != 0;
+            parsed.birth_min = (uint16_t)b_min;
+            parsed.birth_max = (uint16_t)b_max;
+            parsed.survive_min = (uint16_t)s_min;
+            parsed.survive_max = (uint16_t)s_max;
+        }
+        rule = parsed;
+        return true;
+    }
+}
+
+bool Rule::parse(const char* text, Rule& rule)
+{
+    std::string s;
+    for (const char* p = text; *p; ++p) {
+        if (!std::isspace((unsigned char)*p)) s += (char)std::toupper((unsigned char)*p);
+    }
+
+    if (s[0] == 'R') {
+        return parse_larger_than_life(s.c_str(), rule);
+    }
+
+    Rule parsed;
+    const char* p = s.c_str();
+    if (*p == 'B') { // B.../S...
+        p = parse_counts(p + 1, parsed.birth);
+        if (*p == '/') ++p;
+        if (*p != 'S') return false;
+        p = parse_counts(p + 1, parsed.survive);
+    }
+    else { // S/B
+        p = parse_counts(p, parsed.survive);
+        if (*p != '/') return false;
+        p = parse_counts(p + 1, parsed.birth);
+    }
+    if (*p == '/' || *p == 'C') { // Generations, "/C3", "C3" or "/3"
+        if (*p == '/') ++p;
+        if (*p == 'C' || *p == 'G') ++p;
+        int states = 0;
+        while (*p >= '0' && *p <= '9' && states <= Rule::MAX_STATES) {
+            states = states * 10 + (*p - '0');
+            ++p;
+        }
+        if (states < 2 || states > Rule::MAX_STATES) return false;
+        parsed.states = (uint8_t)states;
+    }
+    if (*p != '\0') return false;
+
+    rule = parsed;
+    return true;
+}
+
+std::string Rule::to_string() const
+{
+    if (is_larger_than_life()) {
+        const int m = middle ? 1 : 0;
+        return "R" + std::to_string(radius) + ",C" + std::to_string(is_generations() ? states : 0) + ",M" + std::to_string(m)
+            + ",S" + std::to_string(survive_min + m) + ".." + std::to_string(survive_max + m)
+            + ",B" + std::to_string(birth_min) + ".." + std::to_string(birth_max) + ",NM";
+    }
+
+    std::string s = "B";
+    for (int n = 0; n <= 8; ++n) {
+        if ((birth >> n) & 1) s += char('0' + n);
+    }
+    s += "/S";
+    for (int n = 0; n <= 8; ++n) {
+        if ((survive >> n) & 1) s += char('0' + n);
+    }
+    if (is_generations()) {
+        s += "/C" + std::to_string(states);
+    }
+    return s;
+}
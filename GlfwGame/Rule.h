@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// A Life-like rule in B/S notation, "B3/S23" is Conway's game of life.
+// bit n of birth: a dead cell with n neighbors becomes alive, bit n of survive: a live cell with n neighbors stays alive.
+// Generations rules ("B2/S/C3" is Brian's Brain) have more than 2 states: a live cell that doesn't survive
+// goes through the dying states 2, 3 .. states - 1 before it is dead, and only live cells count as neighbors.
+// Larger than Life rules ("R5,C0,M1,S34..58,B34..45,NM" is Bosco's rule) count the (2 * radius + 1)^2 square
+// around the cell instead, with a range of counts for birth and survival
+struct Rule
+{
+	static constexpr int MAX_STATES = 16; // dying cells fit in 4 bits
+	static constexpr int MAX_RADIUS = 10;
+
+	uint16_t birth = 1 << 3;
+	uint16_t survive = (1 << 2) | (1 << 3);
+	uint8_t states = 2;
+
+	// Larger than Life, radius > 1. the ranges count neighbors without the cell itself,
+	// middle only says if the rule was written with the cell included (M1). an empty range is 1..0
+	uint8_t radius = 1;
+	bool middle = false;
+	uint16_t birth_min = 0, birth_max = 0;
+	uint16_t survive_min = 0, survive_max = 0;
+
+	// the live cells follow B3/S23, dying states or not
+	bool is_conway() const { return radius == 1 && birth == (1 << 3) && survive == ((1 << 2) | (1 << 3)); }
+	bool is_generations() const { return states > 2; }
+	bool is_larger_than_life() const { return radius > 1; }
+	// B0, an empty universe doesn't stay empty
+	bool births_from_nothing() const { return is_larger_than_life() ? birth_min == 0 : (birth & 1); }
+	bool next(bool alive, int neighbors) const
+	{
+		if (is_larger_than_life()) {
+			return alive ? (survive_min <= neighbors && neighbors <= survive_max) : (birth_min <= neighbors && neighbors <= birth_max);
+		}
+		return ((alive ? survive : birth) >> neighbors) & 1;
+	}
+
+	// "B36/S23", "b3s23" or the older S/B form "23/36", with "/C3" or "/3" after it for Generations.
+	// Larger than Life as "R5,C0,M1,S34..58,B34..45,NM", only the Moore (square) neighborhood.
+	// returns false if text isn't a rule
+	static bool parse(const char* text, Rule& rule);
+	std::string to_string() const; // always B/S(/C) form, or R,C,M,S,B,N for Larger than Life
+
+	bool operator==(const Rule& o) const
+	{
+		return birth == o.birth && survive == o.survive && states == o.states && radius == o.radius && middle == o.middle
+			&& birth_min == o.birth_min && birth_max == o.birth_max && survive_min == o.survive_min && survive_max == o.survive_max;
+	}
+	bool operator!=(const Rule& o) const { return !(*this == o); }
+};
@@ -0,0 +1,189 @@
+#include "Simulation.h"
+
+#include <chrono>
+
+Simulation::Simulation(int width, int height, LifeGrid::Boundary boundary, const Rule& rule, int threads)
+    : m_universe(width, height, threads)
+{
+    m_universe.set_boundary(boundary);
+    m_universe.set_rule(rule);
+    m_thread = std::thread(&Simulation::run, this);
+}
+
+Simulation::~Simulation()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+}
+
+void Simulation::post(std::function<void(Universe&)> command)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_commands.push_back(std::move(command));
+    }
+    m_cv.notify_one();
+}
+
+void Simulation::with_universe(const std::function<void(Universe&)>& f)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_universe_mutex);
+        f(m_universe);
+        m_changed = true;
+    }
+    // wake it up for the frame
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cv.notify_one();
+}
+
+void Simulation::set_paused(bool paused)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paused = paused;
+    m_cv.notify_one();
+}
+
+void Simulation::set_idle(bool idle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_idle = idle;
+    m_cv.notify_one();
+}
+
+void Simulation::set_rate(double rate)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_rate = rate;
+    m_cv.notify_one();
+}
+
+void Simulation::take_stats(std::vector<LifeStats>& stats)
+{
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    stats.insert(stats.end(), m_stats.begin(), m_stats.end());
+    m_stats.clear();
+}
+
+void Simulation::run()
+{
+    std::vector<std::function<void(Universe&)>> commands;
+    bool stale = true; // the newest frame isn't of the current generation
+    bool was_running = false;
+    auto last_time = std::chrono::steady_clock::now();
+    while (true) {
+        bool stepping;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true) {
+                if (m_quit) return;
+                const bool running = !m_paused && !m_idle;
+                const auto now = std::chrono::steady_clock::now();
+                if (m_timestep.rate() != m_rate) {
+                    m_timestep.set_rate(m_rate);
+                }
+                if (running && !was_running) {
+                    m_timestep.reset(); // the first generation right away, no catching up on the time spent paused
+                }
+                else if (running) {
+                    m_timestep.advance(std::chrono::duration<double>(now - last_time).count());
+                }
+                last_time = now;
+                was_running = running;
+
+                // stale: the last generation stepped before pausing (or between two due ones) still has to be shown
+                stepping = running && m_timestep.take();
+                if (stepping || !m_commands.empty() || m_changed || (stale && !m_idle)) break;
+                if (running) {
+                    m_cv.wait_for(lock, std::chrono::duration<double>(m_timestep.seconds_until_next()));
+                }
+                else {
+                    m_cv.wait(lock);
+                }
+            }
+            commands.swap(m_commands);
+        }
+
+        std::lock_guard<std::mutex> lock(m_universe_mutex);
+        for (auto& command : commands) {
+            command(m_universe);
+            stale = true;
+        }
+        commands.clear();
+        if (m_changed.exchange(false)) {
+            stale = true;
+        }
+
+        if (stepping) {
+            m_universe.step();
+            stale = true;
+
+            // stop when nothing new will happen, once per cycle
+            if (m_universe.period() != m_paused_period) {
+                m_paused_period = m_universe.period();
+                if (m_paused_period) {
+                    m_paused = true;
+                    stepping = false;
+                }
+            }
+        }
+
+        // commands can step (or go back) too, edits of the same generation don't count
+        const LifeStats& stats = m_universe.stats();
+        if (stats.generation != m_stats_generation) {
+            std::lock_guard<std::mutex> stats_lock(m_stats_mutex);
+            if (m_stats.size() == MAX_STATS) {
+                m_stats.pop_front();
+            }
+            m_stats.push_back(stats);
+            m_stats_generation = stats.generation;
+        }
+
+        // when paused every change is shown, when stepping the render thread takes what is newest once it wants another
+        if (stale && !m_idle && (!stepping || !m_frames.fresh())) {
+            make_frame(m_frames.back());
+            m_frames.publish();
+            stale = false;
+        }
+    }
+}
+
+void Simulation::make_frame(Frame& frame) const
+{
+    const int width = m_universe.width(), height = m_universe.height();
+    frame.colors.resize(size_t(width) * height);
+    frame.generation = m_universe.generation();
+    frame.period = m_universe.period();
+    frame.cycle_start = m_universe.cycle_start();
+    frame.stats = m_universe.stats();
+
+    // sum up the age of dying cells from the planes, then turn it into a shade
+    const LifeGrid& grid = m_universe.grid();
+    const Generations& generations = m_universe.generations();
+    const int planes = generations.plane_count();
+    const int oldest = generations.states() - 2;
+    for (int i = 0; i < height; ++i) {
+        const uint64_t* row = grid.row(i);
+        unsigned char* colors = &frame.colors[size_t(i) * width];
+        for (int j = 0; j < width; ++j) {
+            colors[j] = ((row[j >> 6] >> (j & 63)) & 1) ? 255 : 0;
+        }
+        for (int p = 0; p < planes; ++p) {
+            const uint64_t* age_row = generations.plane(p).row(i);
+            for (int j = 0; j < width; ++j) {
+                colors[j] |= ((age_row[j >> 6] >> (j & 63)) & 1) << p;
+            }
+        }
+        if (planes) {
+            for (int j = 0; j < width; ++j) {
+                if (colors[j] != 0 && colors[j] != 255) {
+                    colors[j] = (unsigned char)(1 + 253 * (oldest - colors[j] + 1) / oldest);
+                }
+            }
+        }
+    }
+}
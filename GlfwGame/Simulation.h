@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "FixedTimestep.h"
+#include "TripleBuffer.h"
+#include "Universe.h"
+
+// The Universe on its own thread, so a slow generation doesn't drop frames and drawing doesn't hold up the generations.
+// Everything that changes the universe is posted to the thread and runs between two generations.
+// Finished generations come back as frames through a TripleBuffer: the render thread always has the newest one
+// without waiting. While stepping, a frame is only made when the last one was picked up, so at most once per drawn frame
+class Simulation
+{
+public:
+	// what gets drawn of one generation
+	struct Frame {
+		std::vector<unsigned char> colors; // one byte per cell: 0 dead, 255 alive, dying cells fade from 254 down to 1
+		uint64_t generation = 0;
+		uint64_t period = 0; // of the cycle the universe is in, 0 if none was found
+		uint64_t cycle_start = 0;
+		LifeStats stats; // see Universe::stats
+	};
+
+	// starts the thread, paused
+	Simulation(int width, int height, LifeGrid::Boundary boundary, const Rule& rule, int threads = 0);
+	~Simulation();
+	Simulation(const Simulation&) = delete;
+	Simulation& operator=(const Simulation&) = delete;
+
+	// run command on the simulation thread before its next generation
+	void post(std::function<void(Universe&)> command);
+	// run f on this thread while the simulation thread waits, for things that need the universe right now.
+	// can wait for a whole generation unless the simulation is paused or idle
+	void with_universe(const std::function<void(Universe&)>& f);
+
+	bool paused() const { return m_paused; }
+	void set_paused(bool paused); // pauses by itself when a cycle is found
+	// doesn't step or make frames even when not paused, e.g. while the gpu steps the cells
+	void set_idle(bool idle);
+	// generations per second while not paused, 0 = as fast as it can (see FixedTimestep)
+	void set_rate(double rate);
+
+	// take the newest frame, returns false if there is none since the last call
+	bool update_frame() { return m_frames.update(); }
+	const Frame& frame() const { return m_frames.front(); }
+
+	// the stats of every generation stepped since the last call (only the last one of a Universe::step(times)),
+	// appended to stats. the newest MAX_STATS are kept in between
+	void take_stats(std::vector<LifeStats>& stats);
+
+private:
+	static constexpr size_t MAX_STATS = size_t(1) << 16;
+
+	void run(); // the simulation thread
+	void make_frame(Frame& frame) const;
+
+	Universe m_universe; // only touched while holding m_universe_mutex
+	std::mutex m_universe_mutex;
+	uint64_t m_paused_period = 0; // cycle that the simulation already paused for
+
+	std::mutex m_mutex; // for the commands and waking up the thread
+	std::condition_variable m_cv;
+	std::vector<std::function<void(Universe&)>> m_commands;
+	std::atomic<bool> m_paused{ true };
+	std::atomic<bool> m_idle{ false };
+	std::atomic<bool> m_changed{ true }; // by with_universe, needs a new frame
+	bool m_quit = false;
+	double m_rate = 60.0;
+	FixedTimestep m_timestep; // only used by the simulation thread
+
+	TripleBuffer<Frame> m_frames;
+	std::mutex m_stats_mutex;
+	std::deque<LifeStats> m_stats; // not taken yet
+	uint64_t m_stats_generation = 0; // of the newest in m_stats
+	std::thread m_thread;
+};
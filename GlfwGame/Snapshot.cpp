@@ -0,0 +1,224 @@
+#include "Snapshot.h"
+#include "Generations.h"
+#include "Universe.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+constexpr char Snapshot::MAGIC[8];
+constexpr uint64_t Snapshot::ENDIAN_CHECK;
+
+namespace
+{
+    constexpr uint32_t HEADER_BYTES = 4096; // one page
+
+    // a whole file mapped copy on write: the pages are read when first touched, writes go to private copies of them
+    class Mapping
+    {
+    public:
+        Mapping() = default;
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+        ~Mapping()
+        {
+            if (!m_data) return;
+#if defined(_WIN32)
+            UnmapViewOfFile(m_data);
+#else
+            munmap(m_data, m_size);
+#endif
+        }
+
+        bool open(const char* path)
+        {
+#if defined(_WIN32)
+            HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return false;
+            LARGE_INTEGER size;
+            HANDLE map = nullptr;
+            if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+                map = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+            }
+            if (map) {
+                m_data = (uint8_t*)MapViewOfFile(map, FILE_MAP_COPY, 0, 0, 0);
+                m_size = (size_t)size.QuadPart;
+                CloseHandle(map); // the view keeps the mapping
+            }
+            CloseHandle(file);
+#else
+            const int file = ::open(path, O_RDONLY);
+            if (file < 0) return false;
+            struct stat info;
+            if (fstat(file, &info) == 0 && info.st_size > 0) {
+                void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+                if (data != MAP_FAILED) {
+                    m_data = (uint8_t*)data;
+                    m_size = (size_t)info.st_size;
+                }
+            }
+            ::close(file); // the mapping keeps the file
+#endif
+            return m_data != nullptr;
+        }
+
+        uint8_t* data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+    };
+
+    // replace path with the finished file, never writing into one that may still be mapped
+    bool replace_file(const char* from, const char* path)
+    {
+#if defined(_WIN32)
+        return MoveFileExA(from, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return std::rename(from, path) == 0;
+#endif
+    }
+}
+
+bool Snapshot::open(const char* path)
+{
+    m_path = path;
+    std::shared_ptr<Mapping> mapping = std::make_shared<Mapping>();
+    if (!mapping->open(path)) {
+        std::cout << "ERROR::FILE_NOT_FOUND: " << path << "\n";
+        return false;
+    }
+    const Header& header = *(const Header*)mapping->data();
+    if (mapping->size() < sizeof(Header) || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        std::cout << "ERROR::SNAPSHOT: not a snapshot: " << path << "\n";
+        return false;
+    }
+    if (header.version != VERSION || header.byte_order != ENDIAN_CHECK) {
+        std::cout << "ERROR::SNAPSHOT: version " << header.version << " or byte order of " << path << " isn't this one's\n";
+        return false;
+    }
+    if (header.width <= 0 || header.height <= 0 || header.header_bytes < sizeof(Header) || header.header_bytes % 8 != 0
+        || header.boundary < 0 || header.boundary >= (int32_t)LifeGrid::Boundary::COUNT
+        || std::memchr(header.rule, '\0', sizeof(header.rule)) == nullptr || !Rule::parse(header.rule, m_rule)
+        || header.planes != Generations::plane_count(m_rule.states)) {
+        std::cout << "ERROR::SNAPSHOT: broken header in " << path << "\n";
+        return false;
+    }
+    const bool empty = header.max_x < header.min_x;
+    if (empty ? header.population != 0
+              : header.min_x < 0 || header.max_x >= header.width || header.min_y < 0 || header.min_y > header.max_y
+                || header.max_y >= header.height || header.population == 0
+                || header.population > uint64_t(header.max_x - header.min_x + 1) * uint64_t(header.max_y - header.min_y + 1)) {
+        std::cout << "ERROR::SNAPSHOT: broken stats in " << path << "\n";
+        return false;
+    }
+    const uint64_t words = uint64_t((header.width + 63) / 64 + 2) * uint64_t(header.height + 2);
+    if (mapping->size() != header.header_bytes + words * sizeof(uint64_t) * (1 + header.planes)) {
+        std::cout << "ERROR::SNAPSHOT: " << path << " is " << mapping->size() << " bytes, not what the header says\n";
+        return false;
+    }
+    m_header = &header;
+    m_mapping = mapping;
+    return true;
+}
+
+bool Snapshot::load(Universe& universe) const
+{
+    const Header& h = header();
+    if (universe.width() != h.width || universe.height() != h.height) {
+        std::cout << "ERROR::SNAPSHOT: " << m_path << " is " << h.width << "x" << h.height << ", not "
+                  << universe.width() << "x" << universe.height() << "\n";
+        return false;
+    }
+    universe.set_rule(m_rule); // open() checked the rest of the header, the planes fit the rule
+    universe.set_boundary((LifeGrid::Boundary)h.boundary);
+
+    // the grids on the mapped words, each one keeps the mapping alive
+    uint64_t* words = (uint64_t*)(((uint8_t*)m_header) + h.header_bytes);
+    LifeGrid grid(h.width, h.height, words, m_mapping);
+    std::vector<LifeGrid> ages;
+    for (int p = 0; p < h.planes; ++p) {
+        words += grid.word_count();
+        ages.emplace_back(h.width, h.height, words, m_mapping);
+    }
+    LifeStats stats;
+    stats.population = h.population;
+    stats.min_x = h.min_x;
+    stats.min_y = h.min_y;
+    stats.max_x = h.max_x;
+    stats.max_y = h.max_y;
+    universe.set_grid(std::move(grid), std::move(ages), h.generation, stats);
+    return true;
+}
+
+void Snapshot::close()
+{
+    m_mapping.reset();
+    m_header = nullptr;
+}
+
+bool write_snapshot(const char* path, Universe& universe)
+{
+#if defined(_WIN32)
+    universe.own_cells();
+#endif
+
+    Snapshot::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, Snapshot::MAGIC, sizeof(header.magic));
+    header.version = Snapshot::VERSION;
+    header.header_bytes = HEADER_BYTES;
+    header.byte_order = Snapshot::ENDIAN_CHECK;
+    header.width = universe.width();
+    header.height = universe.height();
+    header.boundary = (int32_t)universe.boundary();
+    header.planes = universe.generations().plane_count();
+    header.generation = universe.generation();
+    const LifeStats& stats = universe.stats();
+    header.population = stats.population;
+    header.min_x = stats.min_x;
+    header.min_y = stats.min_y;
+    header.max_x = stats.max_x;
+    header.max_y = stats.max_y;
+    std::strncpy(header.rule, universe.rule().to_string().c_str(), sizeof(header.rule) - 1);
+
+    // into a new file that replaces path when it's done, path may be the mapped snapshot the grid is in
+    const std::string temporary = std::string(path) + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        std::vector<char> page(HEADER_BYTES, 0);
+        std::memcpy(page.data(), &header, sizeof(header));
+        file.write(page.data(), page.size());
+        const LifeGrid& grid = universe.grid();
+        file.write((const char*)grid.words(), grid.word_count() * sizeof(uint64_t));
+        for (int p = 0; p < header.planes; ++p) {
+            const LifeGrid& plane = universe.generations().plane(p);
+            file.write((const char*)plane.words(), plane.word_count() * sizeof(uint64_t));
+        }
+        if (!file.flush()) {
+            std::cout << "ERROR::FILE: can't write " << temporary << "\n";
+            return false;
+        }
+    }
+    if (!replace_file(temporary.c_str(), path)) {
+        std::cout << "ERROR::FILE: can't replace " << path << ", it is still the one before\n";
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
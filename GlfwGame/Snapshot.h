@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "LifeGrid.h"
+#include "Rule.h"
+
+class Universe;
+
+// Binary snapshots of the universe: a header, then the words of the grid exactly as they are in memory
+// (halo included, see LifeGrid::words) and after it the planes of the dying states.
+// Loading maps the file (copy on write) and the grid uses the mapped words as they are, so nothing is read
+// until a generation touches it, and saving is one write per grid. For checkpoints of huge grids, not for exchange:
+// the words are in the byte order of the machine, a file from another one is refused
+class Snapshot
+{
+public:
+	static constexpr uint32_t VERSION = 2;
+
+	struct Header {
+		char magic[8]; // MAGIC
+		uint32_t version; // VERSION
+		uint32_t header_bytes; // where the words start, whole pages so they can be mapped
+		uint64_t byte_order; // ENDIAN_CHECK as the machine that wrote it has it
+		int32_t width, height;
+		int32_t boundary; // LifeGrid::Boundary
+		int32_t planes; // of dying states, after the grid
+		uint64_t generation;
+		uint64_t population; // and the box around the live cells (see LifeStats), so loading doesn't count them
+		int32_t min_x, min_y, max_x, max_y;
+		char rule[256]; // Rule::to_string, zero terminated
+	};
+
+	// maps the file and checks the header, prints an error and returns false if it isn't a snapshot
+	bool open(const char* path);
+	const Header& header() const { return *m_header; }
+	const Rule& rule() const { return m_rule; }
+
+	// the rule, boundary, generation and cells into universe, which has to be the size of the snapshot.
+	// the cells stay in the mapped file (the universe keeps it open), returns false if the size is wrong
+	// and leaves the universe as it was
+	bool load(Universe& universe) const;
+	// let go of the file, the grids loaded from it keep it mapped until they are gone (see Universe::own_cells)
+	void close();
+
+private:
+	static constexpr char MAGIC[8] = { 'G', 'L', 'F', 'W', 'L', 'I', 'F', 'E' };
+	static constexpr uint64_t ENDIAN_CHECK = 0x0102030405060708ull;
+
+	std::shared_ptr<void> m_mapping; // unmaps the file when the last grid using it is gone
+	const Header* m_header = nullptr;
+	Rule m_rule;
+	const char* m_path = "";
+
+	friend bool write_snapshot(const char* path, Universe& universe);
+};
+
+// the current generation of universe to path, see Snapshot. prints an error and returns false if it can't be written,
+// path is then the file it was before. on windows the universe copies its cells out of a mapped snapshot first,
+// path may be the one it was loaded from, which can't be replaced while it's mapped
+bool write_snapshot(const char* path, Universe& universe);
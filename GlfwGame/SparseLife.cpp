@@ -0,0 +1,164 @@
+#include "SparseLife.h"
+#include "LifeGrid.h"
+#include "LifeKernel.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <bitset>
+
+namespace
+{
+    // floor division, so chunk -1 holds cells -64 to -1
+    int64_t chunk_of(int64_t v) { return v >= 0 ? v / SparseLife::CHUNK_SIZE : -((-v + SparseLife::CHUNK_SIZE - 1) / SparseLife::CHUNK_SIZE); }
+}
+
+bool SparseLife::get(int64_t x, int64_t y) const
+{
+    const int64_t cx = chunk_of(x), cy = chunk_of(y);
+    const Chunk* chunk = find(cx, cy);
+    if (!chunk) return false;
+    return ((*chunk)[y - cy * CHUNK_SIZE] >> (x - cx * CHUNK_SIZE)) & 1;
+}
+
+void SparseLife::set(int64_t x, int64_t y, bool alive)
+{
+    const int64_t cx = chunk_of(x), cy = chunk_of(y);
+    auto it = m_chunks.find(key(cx, cy));
+    if (it == m_chunks.end()) {
+        if (!alive) return;
+        it = m_chunks.emplace(key(cx, cy), Chunk()).first;
+        it->second.fill(0);
+    }
+    uint64_t& word = it->second[y - cy * CHUNK_SIZE];
+    const uint64_t bit = uint64_t(1) << (x - cx * CHUNK_SIZE);
+    word = alive ? (word | bit) : (word & ~bit);
+}
+
+void SparseLife::load(const LifeGrid& grid)
+{
+    clear();
+    for (int cy = 0; cy * CHUNK_SIZE < grid.height(); ++cy) {
+        for (int cx = 0; cx < grid.words_per_row(); ++cx) {
+            Chunk chunk;
+            uint64_t any = 0;
+            for (int y = 0; y < CHUNK_SIZE; ++y) {
+                const int row = cy * CHUNK_SIZE + y;
+                chunk[y] = row < grid.height() ? grid.row(row)[cx] : 0;
+                any |= chunk[y];
+            }
+            if (any) {
+                m_chunks.emplace(key(cx, cy), chunk);
+            }
+        }
+    }
+}
+
+void SparseLife::store(LifeGrid& grid) const
+{
+    grid.clear();
+    for (const auto& entry : m_chunks) {
+        const int64_t cx = key_x(entry.first), cy = key_y(entry.first);
+        if (cx < 0 || cy < 0 || cx >= grid.words_per_row() || cy * CHUNK_SIZE >= grid.height()) continue;
+
+        const uint64_t mask = (cx == grid.words_per_row() - 1) ? grid.tail_mask() : ~uint64_t(0);
+        for (int y = 0; y < CHUNK_SIZE && cy * CHUNK_SIZE + y < grid.height(); ++y) {
+            grid.row(int(cy * CHUNK_SIZE + y))[cx] = entry.second[y] & mask;
+        }
+    }
+}
+
+uint64_t SparseLife::population() const
+{
+    uint64_t population = 0;
+    for (const auto& entry : m_chunks) {
+        for (uint64_t word : entry.second) {
+            population += std::bitset<64>(word).count();
+        }
+    }
+    return population;
+}
+
+const SparseLife::Chunk* SparseLife::find(int64_t cx, int64_t cy) const
+{
+    auto it = m_chunks.find(key(cx, cy));
+    return it == m_chunks.end() ? nullptr : &it->second;
+}
+
+void SparseLife::step(const Rule& rule, ThreadPool& pool)
+{
+    // every chunk with cells in it, plus the neighbors its edge cells could give birth into
+    std::unordered_set<uint64_t> candidates;
+    for (const auto& entry : m_chunks) {
+        const int64_t cx = key_x(entry.first), cy = key_y(entry.first);
+        const Chunk& c = entry.second;
+        uint64_t any = 0;
+        for (uint64_t word : c) any |= word;
+
+        const bool north = c[0] != 0, south = c[CHUNK_SIZE - 1] != 0;
+        const bool west = (any & 1) != 0, east = (any >> 63) != 0;
+
+        candidates.insert(entry.first);
+        if (north) candidates.insert(key(cx, cy - 1));
+        if (south) candidates.insert(key(cx, cy + 1));
+        if (west) candidates.insert(key(cx - 1, cy));
+        if (east) candidates.insert(key(cx + 1, cy));
+        if (north && west && (c[0] & 1)) candidates.insert(key(cx - 1, cy - 1));
+        if (north && east && (c[0] >> 63)) candidates.insert(key(cx + 1, cy - 1));
+        if (south && west && (c[CHUNK_SIZE - 1] & 1)) candidates.insert(key(cx - 1, cy + 1));
+        if (south && east && (c[CHUNK_SIZE - 1] >> 63)) candidates.insert(key(cx + 1, cy + 1));
+    }
+
+    const std::vector<uint64_t> keys(candidates.begin(), candidates.end());
+    std::vector<Chunk> next(keys.size());
+    std::vector<uint8_t> alive(keys.size());
+
+    constexpr int CHUNKS_PER_TASK = 64;
+    const int tasks = int((keys.size() + CHUNKS_PER_TASK - 1) / CHUNKS_PER_TASK);
+    pool.run(tasks, [&](int task) {
+        const size_t end = std::min(keys.size(), size_t(task + 1) * CHUNKS_PER_TASK);
+        for (size_t i = size_t(task) * CHUNKS_PER_TASK; i < end; ++i) {
+            alive[i] = step_chunk(key_x(keys[i]), key_y(keys[i]), rule, next[i]);
+        }
+    });
+
+    // chunks that died out are not put back, that frees them
+    std::unordered_map<uint64_t, Chunk> chunks;
+    chunks.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (alive[i]) {
+            chunks.emplace(keys[i], next[i]);
+        }
+    }
+    m_chunks.swap(chunks);
+}
+
+bool SparseLife::step_chunk(int64_t cx, int64_t cy, const Rule& rule, Chunk& out) const
+{
+    // the chunk with one cell of its neighbors around it, as 3 words per row: west, chunk, east
+    static const Chunk empty_chunk = {};
+    const Chunk* around[3][3];
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            const Chunk* c = find(cx + dx, cy + dy);
+            around[dy + 1][dx + 1] = c ? c : &empty_chunk;
+        }
+    }
+
+    uint64_t rows[CHUNK_SIZE + 2][3];
+    for (int y = -1; y <= CHUNK_SIZE; ++y) {
+        const int r = y < 0 ? 0 : (y < CHUNK_SIZE ? 1 : 2);
+        const int wy = y < 0 ? CHUNK_SIZE - 1 : (y < CHUNK_SIZE ? y : 0);
+        for (int x = 0; x < 3; ++x) {
+            rows[y + 1][x] = (*around[r][x])[wy];
+        }
+    }
+
+    const LifeKernel::RowFunction step_row = LifeKernel::row_function(rule);
+    uint64_t any = 0;
+    for (int y = 0; y < CHUNK_SIZE; ++y) {
+        step_row(&rows[y][1], &rows[y + 1][1], &rows[y + 2][1], &out[y], 1, rule);
+        any |= out[y];
+    }
+    return any != 0;
+}
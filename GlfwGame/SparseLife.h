@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+class LifeGrid;
+class ThreadPool;
+struct Rule;
+
+// Unbounded universe that only stores the 64x64 chunks that have live cells in them,
+// in a hash map keyed by chunk coordinate. Chunks next to live edges are created when stepping,
+// and chunks that die out are freed, so memory follows the live area and nothing dies at an edge.
+// Empty space has to stay empty, so rules with B0 can't be stepped here.
+class SparseLife
+{
+public:
+	static constexpr int CHUNK_SIZE = 64; // cells in each direction, one word per row
+
+	bool get(int64_t x, int64_t y) const;
+	void set(int64_t x, int64_t y, bool alive);
+	void clear() { m_chunks.clear(); }
+	void load(const LifeGrid& grid); // replace everything with the cells of grid, at (0, 0)
+	void store(LifeGrid& grid) const; // the cells in the area of grid, at (0, 0)
+
+	void step(const Rule& rule, ThreadPool& pool);
+
+	size_t chunk_count() const { return m_chunks.size(); }
+	uint64_t population() const;
+
+private:
+	using Chunk = std::array<uint64_t, CHUNK_SIZE>; // bit x of word y is cell (x, y)
+
+	static uint64_t key(int64_t cx, int64_t cy) { return (uint64_t(uint32_t(cx)) << 32) | uint32_t(cy); }
+	static int64_t key_x(uint64_t key) { return int32_t(key >> 32); }
+	static int64_t key_y(uint64_t key) { return int32_t(key & 0xFFFFFFFF); }
+
+	const Chunk* find(int64_t cx, int64_t cy) const;
+	bool step_chunk(int64_t cx, int64_t cy, const Rule& rule, Chunk& out) const; // returns if anything is alive
+
+	std::unordered_map<uint64_t, Chunk> m_chunks;
+};
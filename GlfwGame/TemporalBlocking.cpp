@@ -0,0 +1,88 @@
+#include "TemporalBlocking.h"
+#include "LifeKernel.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+    constexpr size_t CACHE_BYTES = size_t(256) << 10; // both small grids of a band
+
+    // the row that row y (up to a grid height above or below the grid) starts as, or -1 for dead
+    int boundary_source(int y, int height, LifeGrid::Boundary boundary)
+    {
+        if (y >= 0 && y < height) return y;
+        switch (boundary) {
+        case LifeGrid::Boundary::Torus: return ((y % height) + height) % height;
+        case LifeGrid::Boundary::Mirror: return y < 0 ? -y - 1 : 2 * height - 1 - y;
+        default: return -1;
+        }
+    }
+
+    struct Scratch {
+        std::unique_ptr<LifeGrid> grids[2];
+    };
+}
+
+void TemporalBlocking::step(const LifeGrid& src, LifeGrid& dst, int generations, const Rule& rule, LifeGrid::Boundary boundary, ThreadPool& pool)
+{
+    const int width = src.width(), height = src.height();
+    const int words = src.words_per_row();
+    const size_t row_bytes = size_t(words + 2) * sizeof(uint64_t) * 2;
+
+    const int pass = generations;
+    const int rows_in_cache = (int)std::max<size_t>(CACHE_BYTES / row_bytes, 1);
+    // the band, and a pass worth of rows above and below it. at least as many band rows as extra rows
+    const int band_rows = std::min(height, std::max(rows_in_cache - 2 * pass, 2 * pass));
+    const int bands = (height + band_rows - 1) / band_rows;
+    const int rows = band_rows + 2 * pass;
+
+    pool.run(bands, [&](int band) {
+        // every thread keeps its small grids for the next band
+        thread_local Scratch scratch;
+        for (auto& grid : scratch.grids) {
+            if (!grid || grid->width() != width || grid->height() < rows) {
+                grid.reset(new LifeGrid(width, rows));
+            }
+        }
+        LifeGrid* a = scratch.grids[0].get();
+        LifeGrid* b = scratch.grids[1].get();
+
+        const int y_begin = band * band_rows;
+        const int y_end = std::min(height, y_begin + band_rows);
+        const int first = y_begin - pass; // row of the grid that is row 0 of the small grids
+        const int last = y_end + pass;
+
+        for (int y = first; y < last; ++y) {
+            const int source = boundary_source(y, height, boundary);
+            uint64_t* out = a->row(y - first);
+            if (source < 0) {
+                std::fill(out, out + words, 0);
+            }
+            else {
+                std::copy(src.row(source), src.row(source) + words, out);
+            }
+        }
+
+        // after g generations rows [g, last - first - g) of the small grid are right
+        for (int g = 0; g < pass; ++g) {
+            const int valid_begin = g, valid_end = last - first - g;
+            a->refresh_halo_columns(boundary, valid_begin, valid_end);
+            LifeKernel::step_rows(*a, *b, valid_begin + 1, valid_end - 1, rule);
+            if (boundary == LifeGrid::Boundary::Dead) { // the rows past the edges stay dead
+                for (int y = valid_begin + 1; y < valid_end - 1 && first + y < 0; ++y) {
+                    std::fill(b->row(y), b->row(y) + words, 0);
+                }
+                for (int y = std::max(valid_begin + 1, height - first); y < valid_end - 1; ++y) {
+                    std::fill(b->row(y), b->row(y) + words, 0);
+                }
+            }
+            std::swap(a, b);
+        }
+
+        for (int y = y_begin; y < y_end; ++y) {
+            std::copy(a->row(y - first), a->row(y - first) + words, dst.row(y));
+        }
+    });
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "LifeGrid.h"
+
+class ThreadPool;
+struct Rule;
+
+// Many generations of a 2 state rule with the 8 neighbors, a band of rows at a time.
+// A band is copied into a small grid together with the rows it will need from above and below,
+// and stepped there several generations while it stays in the cache, the rows that are still right
+// shrinking by one on each side per generation. Only the band itself goes back to the big grid,
+// so a generation doesn't have to stream the whole grid through memory, which is all that limits the kernels on big grids.
+namespace TemporalBlocking
+{
+	constexpr int MAX_GENERATIONS = 8; // in one call, the rows stepped for nothing grow with it (2 per generation and band)
+
+	// step src generations times into dst (which can't be src), at most MAX_GENERATIONS and the height of the grid.
+	// the halo of src isn't used, bits past the width are cleared in dst
+	void step(const LifeGrid& src, LifeGrid& dst, int generations, const Rule& rule, LifeGrid::Boundary boundary, ThreadPool& pool);
+}
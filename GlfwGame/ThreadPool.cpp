@@ -0,0 +1,96 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threads)
+{
+    start_workers(threads);
+}
+
+ThreadPool::~ThreadPool()
+{
+    stop_workers();
+}
+
+void ThreadPool::set_thread_count(int threads)
+{
+    stop_workers();
+    start_workers(threads);
+}
+
+void ThreadPool::run(int tasks, const std::function<void(int)>& task)
+{
+    if (m_workers.empty() || tasks <= 1) {
+        for (int i = 0; i < tasks; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_tasks = tasks;
+        m_next_task = 0;
+        m_busy_workers = (int)m_workers.size();
+        ++m_job_nr;
+    }
+    m_cv_start.notify_all();
+
+    do_tasks();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv_done.wait(lock, [this] { return m_busy_workers == 0; });
+    m_task = nullptr;
+}
+
+void ThreadPool::start_workers(int threads)
+{
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+    m_quit = false;
+    for (int i = 1; i < threads; ++i) { // the calling thread is the first one
+        m_workers.emplace_back(&ThreadPool::worker_loop, this, m_job_nr);
+    }
+}
+
+void ThreadPool::stop_workers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_cv_start.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void ThreadPool::worker_loop(unsigned int last_job)
+{
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv_start.wait(lock, [&] { return m_quit || m_job_nr != last_job; });
+            if (m_quit) return;
+            last_job = m_job_nr;
+        }
+
+        do_tasks();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_busy_workers;
+        }
+        m_cv_done.notify_one();
+    }
+}
+
+void ThreadPool::do_tasks()
+{
+    while (true) {
+        const int i = m_next_task.fetch_add(1);
+        if (i >= m_tasks) return;
+        (*m_task)(i);
+    }
+}
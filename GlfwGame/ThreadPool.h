@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+// Persistent worker threads, so stepping a generation doesn't have to start new ones.
+// The thread calling run() works on the tasks too.
+class ThreadPool
+{
+public:
+	explicit ThreadPool(int threads = 0); // total threads including the caller, 0 = all cores
+	~ThreadPool();
+
+	int thread_count() const { return (int)m_workers.size() + 1; }
+	void set_thread_count(int threads); // 0 = all cores
+
+	// call task(i) for every i in [0, tasks), spread over the threads. returns when all are done
+	void run(int tasks, const std::function<void(int)>& task);
+
+private:
+	void start_workers(int threads);
+	void stop_workers();
+	void worker_loop(unsigned int last_job);
+	void do_tasks(); // take tasks until there are none left
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_cv_start;
+	std::condition_variable m_cv_done;
+
+	// current job
+	const std::function<void(int)>* m_task = nullptr;
+	int m_tasks = 0;
+	std::atomic<int> m_next_task{ 0 };
+	int m_busy_workers = 0;
+	unsigned int m_job_nr = 0; // workers wait for this to change
+	bool m_quit = false;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Hands the newest value from one thread (the producer) to another (the consumer) without either of them waiting.
+// The producer fills back() and publishes it, the consumer picks up the latest one with update() and reads front().
+// The third buffer is the one in the middle: the last published value, that nobody is using.
+// What is in back() after publish() is an old value, the producer has to fill all of it again
+template <typename T>
+class TripleBuffer
+{
+public:
+	// producer
+	T& back() { return m_buffers[m_back]; }
+	void publish()
+	{
+		m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+	// there is a published value that the consumer didn't pick up yet
+	bool fresh() const { return (m_middle.load(std::memory_order_acquire) & FRESH) != 0; }
+
+	// consumer. returns false (and keeps front) if nothing was published since the last update
+	bool update()
+	{
+		if (!fresh()) return false;
+		m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+	const T& front() const { return m_buffers[m_front]; }
+
+private:
+	static constexpr uint8_t INDEX = 3;
+	static constexpr uint8_t FRESH = 4;
+
+	std::array<T, 3> m_buffers;
+	uint8_t m_front = 0;
+	std::atomic<uint8_t> m_middle{ 1 }; // index, and FRESH once published
+	uint8_t m_back = 2;
+};
@@ -0,0 +1,513 @@
+#include "Universe.h"
+#include "LifeKernel.h"
+#include "LargerThanLife.h"
+#include "Random.h"
+#include "TemporalBlocking.h"
+
+#include <algorithm>
+
+Universe::Universe(int width, int height, int threads)
+    : m_buffers{ { LifeGrid(width, height), LifeGrid(width, height) } },
+      m_thread_pool(threads),
+      m_active_tiles(m_buffers[0]),
+      m_generations(width, height),
+      m_changes(width, height)
+{
+}
+
+void Universe::set(int x, int y, bool alive)
+{
+    const bool changed = m_buffers[m_buf_nr].get(x, y) != alive;
+    m_buffers[m_buf_nr].set(x, y, alive);
+    if (changed && alive) {
+        m_stats.add_cell(x, y);
+    }
+    else if (changed) {
+        --m_stats.population;
+        if (x == m_stats.min_x || x == m_stats.max_x || y == m_stats.min_y || y == m_stats.max_y) {
+            count_box();
+        }
+    }
+    m_active_tiles.mark_cell(x, y);
+    m_changes.mark_cell(x, y);
+    m_generations.clear_cell(x, y);
+    forget_cycle();
+    if (m_engine == Engine::HashLife) {
+        m_hashlife.set(x, y, alive);
+    }
+    else if (m_engine == Engine::Sparse) {
+        m_sparse.set(x, y, alive);
+    }
+}
+
+void Universe::randomize(uint64_t seed, double density)
+{
+    Random(seed).fill(m_buffers[m_buf_nr], density, &m_thread_pool);
+    m_generations.clear();
+    m_active_tiles.mark_all();
+    m_changes.invalidate();
+    forget_cycle();
+    load_engine();
+    count_stats(nullptr);
+}
+
+void Universe::clear()
+{
+    m_buffers[m_buf_nr].clear();
+    m_generations.clear();
+    m_active_tiles.mark_all();
+    m_changes.invalidate();
+    forget_cycle();
+    load_engine();
+    count_stats(nullptr);
+}
+
+bool Universe::load_cells(const std::function<bool(LifeGrid&)>& fill)
+{
+    // into the other buffer, which only has the generation before, so a broken file doesn't change the current one
+    LifeGrid& cells = m_buffers[1 - m_buf_nr];
+    cells.clear();
+    const bool result = fill(cells);
+    m_active_tiles.mark_all(); // the other buffer isn't the generation before any more
+    m_changes.invalidate();
+    forget_hashes();
+    if (!result) {
+        return false;
+    }
+    cells.clear_halo(); // nothing past the width
+    m_buf_nr = 1 - m_buf_nr;
+    m_generations.clear();
+    forget_cycle();
+    load_engine();
+    count_stats(nullptr);
+    return result;
+}
+
+bool Universe::load_tree(const std::function<bool(HashLife&)>& fill)
+{
+    if (!fill(m_hashlife)) {
+        return false; // the tree is as it was
+    }
+    m_hashlife.center_origin(width(), height());
+    m_hashlife.store(m_buffers[m_buf_nr]);
+    m_generations.clear();
+    m_active_tiles.mark_all();
+    m_changes.invalidate();
+    forget_cycle();
+    if (m_engine != Engine::HashLife && supports_rule(Engine::HashLife, m_rule)) {
+        // not set_engine, that would load the tree from the grid
+        m_stepping_changes = false;
+        m_engine = Engine::HashLife;
+    }
+    else if (m_engine != Engine::HashLife) {
+        load_engine();
+    }
+    count_stats(nullptr);
+    return true;
+}
+
+void Universe::set_grid(LifeGrid&& grid, std::vector<LifeGrid>&& ages, uint64_t generation, const LifeStats& stats)
+{
+    m_buffers[m_buf_nr] = std::move(grid);
+    m_generations.set_planes(std::move(ages));
+    m_generation = generation;
+    m_active_tiles.mark_all();
+    m_changes.invalidate();
+    forget_cycle();
+    load_engine();
+    m_stats = stats;
+    m_stats.births = m_stats.deaths = 0; // like after every other edit of the whole grid
+    m_stats.generation = m_generation;
+}
+
+void Universe::own_cells()
+{
+    for (LifeGrid& buffer : m_buffers) {
+        buffer.own_words();
+    }
+    m_generations.own_words();
+}
+
+void Universe::set_history_bytes(size_t bytes)
+{
+    m_history.set_max_bytes(bytes);
+    m_history.record(m_buffers[m_buf_nr], m_generation); // so there is something to go back to
+}
+
+bool Universe::rewind(uint64_t generation)
+{
+    if (!m_history.restore(generation, m_buffers[m_buf_nr])) {
+        return false;
+    }
+    m_generation = generation;
+    m_generations.clear();
+    m_active_tiles.mark_all();
+    m_changes.invalidate();
+    forget_cycle();
+    load_engine();
+    count_stats(nullptr);
+    return true;
+}
+
+void Universe::set_states(const std::vector<uint8_t>& states, uint64_t generation)
+{
+    LifeGrid& grid = m_buffers[m_buf_nr];
+    for (int i = 0; i < height(); ++i) {
+        for (int j = 0; j < width(); ++j) {
+            const int state = states[size_t(i) * width() + j];
+            grid.set(j, i, state == 1);
+            m_generations.set_age(j, i, state > 1 ? state - 1 : 0);
+        }
+    }
+    m_generation = generation;
+    m_active_tiles.mark_all();
+    m_changes.invalidate();
+    forget_cycle();
+    load_engine();
+    count_stats(nullptr);
+}
+
+void Universe::step()
+{
+    // the unbounded engines store into the other buffer too, so the one before is still there for the stats
+    if (m_engine == Engine::HashLife) {
+        m_hashlife.step();
+        m_buf_nr = 1 - m_buf_nr;
+        m_hashlife.store(m_buffers[m_buf_nr]);
+        m_active_tiles.mark_all();
+        m_generation += uint64_t(1) << m_hashlife.step_exponent();
+        count_stats(&m_buffers[1 - m_buf_nr]);
+    }
+    else if (m_engine == Engine::Sparse) {
+        m_sparse.step(m_rule, m_thread_pool);
+        m_buf_nr = 1 - m_buf_nr;
+        m_sparse.store(m_buffers[m_buf_nr]);
+        m_active_tiles.mark_all();
+        ++m_generation;
+        count_stats(&m_buffers[1 - m_buf_nr]);
+    }
+    else {
+        const Stepped stepped = step_bounded();
+        if (m_cycle_detection) {
+            track_cycle(stepped);
+        }
+    }
+    m_history.record(m_buffers[m_buf_nr], m_generation);
+}
+
+void Universe::step(uint64_t times)
+{
+    if (m_engine == Engine::HashLife) {
+        const int exponent = m_hashlife.step_exponent();
+        const uint64_t big_steps = exponent < 64 ? times >> exponent : 0;
+        for (uint64_t i = 0; i < big_steps; ++i) {
+            step();
+        }
+        for (int e = std::min(exponent, 64) - 1; e >= 0; --e) {
+            if ((times >> e) & 1) {
+                m_hashlife.set_step_exponent(e);
+                step();
+            }
+        }
+        m_hashlife.set_step_exponent(exponent);
+        return;
+    }
+
+    // Generations rules have the planes too, and Larger than Life reads further than the 8 neighbors.
+    // the history wants every generation
+    const bool blocked = m_engine == Engine::Dense && !m_rule.is_generations() && !m_rule.is_larger_than_life() && !m_history.enabled();
+    if (!blocked || times < 2) {
+        for (uint64_t i = 0; i < times; ++i) {
+            step();
+        }
+        return;
+    }
+
+    // the last generation is stepped on its own, for its births and deaths
+    for (uint64_t left = times - 1; left > 0;) {
+        const int pass = (int)std::min<uint64_t>({ left, (uint64_t)TemporalBlocking::MAX_GENERATIONS, (uint64_t)height() });
+        m_buf_nr = 1 - m_buf_nr;
+        TemporalBlocking::step(m_buffers[1 - m_buf_nr], m_buffers[m_buf_nr], pass, m_rule, m_boundary, m_thread_pool);
+        m_generation += pass;
+        left -= pass;
+    }
+    m_active_tiles.mark_all(); // the tiles don't know what changed
+    m_changes.invalidate();
+    forget_cycle();
+    count_stats(nullptr);
+    step();
+}
+
+Universe::Stepped Universe::step_bounded()
+{
+    const int old_buf = m_buf_nr;
+    m_buf_nr = 1 - old_buf;
+    const int new_buf = m_buf_nr;
+
+    if (m_rule.is_larger_than_life()) {
+        // reads past the 1 cell halo, and changes can reach further than the neighboring tiles
+        LargerThanLife::step(m_buffers[old_buf], m_buffers[new_buf], m_rule, m_boundary, m_thread_pool);
+        m_generations.step(m_buffers[old_buf], m_buffers[new_buf], m_thread_pool);
+        m_active_tiles.mark_all();
+        ++m_generation;
+        count_stats(&m_buffers[old_buf]);
+        return Stepped::All;
+    }
+
+    // the halo is filled once per generation, so the kernel never has to care about edges
+    m_buffers[old_buf].refresh_halo(m_boundary);
+
+    if (m_engine == Engine::Changes && m_changes.valid()) {
+        // switch to the list below 1 change per 1024 cells, and back to the tiles above 1 per 256
+        const size_t cells = size_t(width()) * height();
+        m_stepping_changes = m_changes.size() <= cells / (m_stepping_changes ? 256 : 1024);
+        if (m_stepping_changes) {
+            m_changes.step(m_buffers[old_buf], m_buffers[new_buf], m_rule, m_boundary);
+            m_buffers[old_buf].clear_halo();
+            m_active_tiles.mark_all(); // the tiles don't know what changed
+            ++m_generation;
+            count_changed_stats();
+            return Stepped::Changes;
+        }
+    }
+
+    if (m_engine == Engine::Lookup || m_rule.is_generations()) {
+        // every row is stepped: the table doesn't know about tiles,
+        // and dying cells change every generation without the live cells changing
+        if (m_engine == Engine::Lookup) {
+            m_lookup.step(m_buffers[old_buf], m_buffers[new_buf], m_thread_pool);
+        }
+        else {
+            LifeKernel::step_rows_parallel(m_buffers[old_buf], m_buffers[new_buf], 0, height(), m_rule, m_thread_pool);
+        }
+        m_buffers[old_buf].clear_halo();
+        m_generations.step(m_buffers[old_buf], m_buffers[new_buf], m_thread_pool);
+        m_active_tiles.mark_all();
+        ++m_generation;
+        count_stats(&m_buffers[old_buf]);
+        return Stepped::All;
+    }
+
+    // apply algorithm 64 cells at a time, only where something changed last generation
+    m_active_tiles.step(m_buffers[old_buf], m_buffers[new_buf], m_rule, m_thread_pool);
+    m_buffers[old_buf].clear_halo();
+    if (m_engine == Engine::Changes) {
+        m_changes.rebuild(m_buffers[old_buf], m_buffers[new_buf]);
+    }
+    ++m_generation;
+    const uint64_t population_before = m_stats.population;
+    m_stats = m_active_tiles.stats(); // counted while stepping
+    m_stats.set_deaths(population_before);
+    m_stats.generation = m_generation;
+    return Stepped::Tiles;
+}
+
+bool Universe::set_engine(Engine engine)
+{
+    const bool possible = supports_rule(engine, m_rule);
+    if (!possible) {
+        engine = Engine::Dense;
+    }
+    if (engine != m_engine) {
+        // the grid already has the current generation, but the other buffer doesn't have the one before
+        m_active_tiles.mark_all();
+        m_changes.invalidate();
+        m_stepping_changes = false;
+        forget_cycle(); // only the bounded engines look for cycles
+        m_engine = engine;
+        load_engine();
+    }
+    return possible;
+}
+
+void Universe::set_rule(const Rule& rule)
+{
+    m_rule = rule;
+    m_hashlife.set_rule(rule);
+    if (!rule.is_larger_than_life()) {
+        m_lookup.set_rule(rule);
+    }
+    if (rule.states != m_generations.states()) {
+        m_generations.set_states(rule.states);
+    }
+    m_active_tiles.mark_all(); // both buffers were stepped with the old rule
+    m_changes.invalidate();
+    forget_cycle();
+    if (!supports_rule(m_engine, rule)) {
+        set_engine(Engine::Dense);
+    }
+}
+
+bool Universe::supports_rule(Engine engine, const Rule& rule)
+{
+    switch (engine) {
+    case Engine::Dense: return true;
+    case Engine::Lookup: return !rule.is_larger_than_life();
+    case Engine::Changes: return !rule.is_larger_than_life() && !rule.is_generations();
+    default: return !rule.births_from_nothing() && !rule.is_generations() && !rule.is_larger_than_life();
+    }
+}
+
+void Universe::set_boundary(LifeGrid::Boundary boundary)
+{
+    m_boundary = boundary;
+    m_active_tiles.set_wrap(boundary == LifeGrid::Boundary::Torus);
+    m_active_tiles.mark_all(); // the edge tiles see different neighbors now
+    m_changes.invalidate();
+    forget_cycle();
+}
+
+void Universe::set_cycle_detection(bool on)
+{
+    m_cycle_detection = on;
+    forget_cycle();
+}
+
+uint64_t Universe::state_hash() const
+{
+    // every grid hashed with its own range of word indexes
+    const uint64_t words = uint64_t(grid().words_per_row()) * height();
+    uint64_t h = grid().hash();
+    for (int i = 0; i < m_generations.plane_count(); ++i) {
+        h ^= m_generations.plane(i).hash((i + 1) * words);
+    }
+    return h;
+}
+
+void Universe::jump(uint64_t generations)
+{
+    const uint64_t period = m_cycles.period();
+    if (period && m_cycle_states.size() == period) {
+        const uint64_t target = m_generation + generations;
+        m_buffers[m_buf_nr] = m_cycle_states[(target - m_cycle_states_begin) % period];
+        m_generation = target;
+        forget_hashes();
+        m_active_tiles.mark_all(); // the other buffer has nothing to do with the new state
+        m_changes.invalidate();
+        count_stats(nullptr);
+        m_history.record(m_buffers[m_buf_nr], m_generation);
+        return;
+    }
+
+    // without the states, whole periods can still be skipped
+    const uint64_t target = m_generation + generations;
+    if (period) {
+        m_generation += generations - generations % period;
+        m_stats.generation = m_generation;
+    }
+    step(target - m_generation);
+}
+
+void Universe::track_cycle(Stepped stepped)
+{
+    const LifeGrid& grid = m_buffers[m_buf_nr];
+    const LifeGrid& before = m_buffers[1 - m_buf_nr];
+    uint64_t& hash = m_hashes[m_buf_nr];
+    if (stepped == Stepped::Changes && m_hashes_valid[1 - m_buf_nr]) {
+        // only the words with changed cells, each once since the hash is a XOR over words
+        const int words = grid.words_per_row();
+        m_changed_words.clear();
+        for (const ChangeList::Cell& c : m_changes.changed()) {
+            m_changed_words.push_back(uint64_t(c.y) * words + (c.x >> 6));
+        }
+        std::sort(m_changed_words.begin(), m_changed_words.end());
+        m_changed_words.erase(std::unique(m_changed_words.begin(), m_changed_words.end()), m_changed_words.end());
+        hash = m_hashes[1 - m_buf_nr];
+        for (uint64_t index : m_changed_words) {
+            const int w = int(index % words), y = int(index / words);
+            hash ^= before.word_hash(w, y) ^ grid.word_hash(w, y);
+        }
+    }
+    else if (stepped == Stepped::Tiles && m_hashes_valid[m_buf_nr]) {
+        // the tiles overwrote the generation before the old one, and know which words they changed
+        hash ^= m_active_tiles.hash_change();
+    }
+    else {
+        hash = state_hash();
+    }
+    m_hashes_valid[m_buf_nr] = true;
+    m_cycles.record(hash, m_generation);
+
+    // keep the states of one period, so jump() can index into them
+    const uint64_t period = m_cycles.period();
+    const size_t grid_bytes = size_t(grid.words_per_row() + 2) * (grid.height() + 2) * sizeof(uint64_t);
+    if (period && m_cycle_states.size() < period && period * grid_bytes <= MAX_CYCLE_BYTES && !m_rule.is_generations()) {
+        if (m_cycle_states.empty()) {
+            m_cycle_states_begin = m_generation;
+        }
+        m_cycle_states.push_back(grid);
+    }
+}
+
+void Universe::forget_cycle()
+{
+    m_cycles.reset();
+    m_cycle_states.clear();
+    forget_hashes();
+}
+
+void Universe::forget_hashes()
+{
+    m_hashes_valid[0] = m_hashes_valid[1] = false;
+}
+
+void Universe::count_stats(const LifeGrid* before)
+{
+    const uint64_t population_before = m_stats.population;
+    m_stats = LifeStats::count(before, m_buffers[m_buf_nr], m_thread_pool);
+    if (before) {
+        m_stats.set_deaths(population_before);
+    }
+    m_stats.generation = m_generation;
+}
+
+void Universe::count_changed_stats()
+{
+    const LifeGrid& grid = m_buffers[m_buf_nr];
+    const LifeStats before = m_stats;
+    m_stats.births = m_stats.deaths = 0;
+    bool shrinks = false; // a cell died on the edge of the box
+    for (const ChangeList::Cell& c : m_changes.changed()) {
+        if (grid.get(c.x, c.y)) {
+            m_stats.add_cell(c.x, c.y);
+            ++m_stats.births;
+        }
+        else {
+            shrinks = shrinks || c.x == before.min_x || c.x == before.max_x || c.y == before.min_y || c.y == before.max_y;
+            ++m_stats.deaths;
+        }
+    }
+    m_stats.population -= m_stats.deaths;
+    m_stats.generation = m_generation;
+    if (shrinks) {
+        count_box();
+    }
+}
+
+void Universe::count_box()
+{
+    const LifeStats box = LifeStats::count(nullptr, m_buffers[m_buf_nr], m_thread_pool);
+    m_stats.min_x = box.min_x; m_stats.max_x = box.max_x;
+    m_stats.min_y = box.min_y; m_stats.max_y = box.max_y;
+}
+
+void Universe::load_engine()
+{
+    if (m_engine == Engine::HashLife) {
+        m_hashlife.load(m_buffers[m_buf_nr]);
+    }
+    else if (m_engine == Engine::Sparse) {
+        m_sparse.load(m_buffers[m_buf_nr]);
+    }
+}
+
+const char* Universe::engine_name(Engine engine)
+{
+    switch (engine) {
+    case Engine::Lookup: return "Lookup";
+    case Engine::Changes: return "Changes";
+    case Engine::HashLife: return "HashLife";
+    case Engine::Sparse: return "Sparse";
+    default: return "Dense";
+    }
+}
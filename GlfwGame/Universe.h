@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "LifeGrid.h"
+#include "Rule.h"
+#include "ThreadPool.h"
+#include "ActiveTiles.h"
+#include "ChangeList.h"
+#include "CycleDetector.h"
+#include "Generations.h"
+#include "HashLife.h"
+#include "History.h"
+#include "LifeStats.h"
+#include "LookupLife.h"
+#include "SparseLife.h"
+
+// The game of life simulation, no opengl in here.
+// Steps either the packed grid (Dense with the SWAR kernels, Lookup with a table of 2x2 blocks,
+// or Changes that only looks at the cells around last generation's changes while there are few of them),
+// a HashLife quadtree or the chunks of an unbounded SparseLife.
+// The grid always has the current generation (for the unbounded engines, the part that lies inside the grid),
+// and is what moves between engines when switching, so cells outside it are left behind.
+class Universe
+{
+public:
+	enum class Engine { Dense, Lookup, Changes, HashLife, Sparse, COUNT };
+
+	Universe(int width, int height, int threads = 0); // threads for stepping generations, 0 = all cores
+
+	int width() const { return m_buffers[0].width(); }
+	int height() const { return m_buffers[0].height(); }
+	const LifeGrid& grid() const { return m_buffers[m_buf_nr]; }
+	bool get(int x, int y) const { return grid().get(x, y); }
+	int state(int x, int y) const { return m_generations.state(grid(), x, y); } // 0 dead, 1 alive, 2.. dying
+	const Generations& generations() const { return m_generations; }
+
+	void set(int x, int y, bool alive); // edit the current generation
+	// every cell alive with probability density, the same soup for the same seed and size everywhere (see Random)
+	void randomize(uint64_t seed, double density = 0.5);
+	void clear(); // set matrix to false for all values
+	// replace the current generation: fill gets a grid with all cells dead and sets the live ones,
+	// e.g. straight from a pattern file. returns what fill returns, if that's false the universe stays as it was
+	bool load_cells(const std::function<bool(LifeGrid&)>& fill);
+	// the same for a HashLife tree, e.g. from a Macrocell file: fill gets the tree and replaces everything in it,
+	// the grid gets the part around the middle. moves to the HashLife engine if it can step the rule,
+	// so what is outside the grid isn't lost. returns what fill returns, if that's false fill has to leave the tree
+	// as it was (HashLife::read_macrocell does) and the universe stays as it was
+	bool load_tree(const std::function<bool(HashLife&)>& fill);
+	// replace the current generation with grid and the ages of its dying cells (see Generations::set_planes),
+	// taking them over without a copy, e.g. from a mapped snapshot. they have to be this size with an all dead halo.
+	// stats has the population and box of grid, which isn't read for counting them
+	void set_grid(LifeGrid&& grid, std::vector<LifeGrid>&& ages, uint64_t generation, const LifeStats& stats);
+	// copy the cells (of both buffers, with the dying states) out of memory that isn't the universe's own,
+	// e.g. before the snapshot file they are mapped from is replaced, which windows doesn't allow while it's mapped
+	void own_cells();
+	// replace the whole grid, one state per cell (see state()) row by row, e.g. from the gpu
+	void set_states(const std::vector<uint8_t>& states, uint64_t generation);
+
+	void step(); // one generation, 2^hashlife_step_exponent() generations with HashLife
+	// that many generations, the same as calling step() that many times but with HashLife, where a step() is
+	// 2^hashlife_step_exponent() of them: it takes as many of those as fit and the rest in smaller powers of two.
+	// Dense steps 2 state rules with the 8 neighbors several generations
+	// per band of rows while it's in the cache (see TemporalBlocking), cycle detection doesn't see those and starts over
+	void step(uint64_t times);
+	uint64_t generation() const { return m_generation; }
+	// population, births, deaths and box of the current generation. births and deaths are since the generation
+	// before (2^hashlife_step_exponent() generations before with HashLife), and none after edits of the whole grid
+	const LifeStats& stats() const { return m_stats; }
+
+	// the bounded engines (Dense, Lookup and Changes) hash every generation and look for it in the last few,
+	// to find out when the universe repeats itself. the hash is updated from the words that changed where the tiles
+	// or the change list stepped, so it only costs as much as there is activity. on by default
+	bool cycle_detection() const { return m_cycle_detection; }
+	void set_cycle_detection(bool on);
+	uint64_t period() const { return m_cycles.period(); } // 0 until a cycle is found, forgotten after edits
+	uint64_t cycle_start() const { return m_cycles.cycle_start(); }
+	uint64_t state_hash() const; // of the current generation, cells and dying states
+
+	// the last generations, in up to bytes of memory (see History). 0 (the default) turns it off.
+	// with it on, every generation is stepped and kept on its own, also by step(times)
+	void set_history_bytes(size_t bytes);
+	const History& history() const { return m_history; }
+	// back (or forward again) to a generation the history has, dying cells are forgotten.
+	// the next step replaces the generations that were after it. returns false if it isn't kept
+	bool rewind(uint64_t generation);
+
+	// advance generations. in a cycle that skips whole periods, and once a whole period has been stepped
+	// (and kept, see MAX_CYCLE_BYTES) the state is just picked out of it, however many generations that is
+	void jump(uint64_t generations);
+
+	Engine engine() const { return m_engine; }
+	// moves the current generation over to the new engine.
+	// returns false and stays on Dense if the engine can't step the rule (see supports_rule)
+	bool set_engine(Engine engine);
+	// Lookup needs the 8 neighbors, Changes 2 states too, the unbounded engines also need empty space to stay empty (no B0)
+	static bool supports_rule(Engine engine, const Rule& rule);
+	static const char* engine_name(Engine engine);
+
+	const Rule& rule() const { return m_rule; }
+	void set_rule(const Rule& rule); // moves back to Dense if the engine can't step the rule, dying cells are forgotten
+
+	// what is past the edge of the grid for Dense, Lookup and Changes, the others are unbounded
+	LifeGrid::Boundary boundary() const { return m_boundary; }
+	void set_boundary(LifeGrid::Boundary boundary);
+
+	const HashLife& hashlife() const { return m_hashlife; } // only up to date with the HashLife engine
+	int hashlife_step_exponent() const { return m_hashlife.step_exponent(); }
+	void set_hashlife_step_exponent(int exponent) { m_hashlife.set_step_exponent(exponent); }
+
+	int thread_count() const { return m_thread_pool.thread_count(); }
+	bool stepping_changes() const { return m_stepping_changes; } // Changes engine is using its list right now
+
+private:
+	static constexpr size_t MAX_CYCLE_BYTES = size_t(64) << 20; // for the states of one period
+
+	void load_engine(); // give the engine in use the cells of the grid
+	enum class Stepped { All, Tiles, Changes }; // what a bounded step went over, which tells what can have changed
+	Stepped step_bounded(); // Dense, Lookup and Changes
+	void track_cycle(Stepped stepped); // after a bounded step
+	void forget_cycle(); // after edits
+	void forget_hashes(); // after anything but a step wrote to a buffer
+	// m_stats of the current generation, stepped from before (or not). m_stats has to be of before until then
+	void count_stats(const LifeGrid* before);
+	void count_changed_stats(); // the same from the change list, after the Changes engine stepped from it
+	void count_box(); // only the box of m_stats, after cells on its edge died
+
+	Engine m_engine = Engine::Dense;
+	LifeGrid::Boundary m_boundary = LifeGrid::Boundary::Dead;
+	Rule m_rule;
+	uint64_t m_generation = 0;
+
+	std::array<LifeGrid, 2> m_buffers;
+	int m_buf_nr = 0; // which buffer is currently active
+	ThreadPool m_thread_pool;
+	ActiveTiles m_active_tiles;
+	Generations m_generations;
+	LookupLife m_lookup;
+	ChangeList m_changes;
+	bool m_stepping_changes = false;
+
+	bool m_cycle_detection = true;
+	CycleDetector m_cycles;
+	// state_hash of what is in each buffer, if it is valid. updated from what changed, not hashed again every step
+	std::array<uint64_t, 2> m_hashes{ { 0, 0 } };
+	std::array<bool, 2> m_hashes_valid{ { false, false } };
+	std::vector<uint64_t> m_changed_words; // scratch for updating the hash from the change list
+	std::vector<LifeGrid> m_cycle_states; // one period of states, starting at generation m_cycle_states_begin
+	uint64_t m_cycle_states_begin = 0;
+
+	HashLife m_hashlife;
+	SparseLife m_sparse;
+	History m_history;
+	LifeStats m_stats;
+};
@@ -6,5 +6,7 @@ in float f_color;
 
 void main()
 {
-	FragColor = vec4(vec3(1.0)*f_color, 1.0);
+	// 1 is alive, less than 1 is a dying cell of a Generations rule, fading from orange to dark blue
+	vec3 dying = mix(vec3(0.1, 0.1, 0.4), vec3(1.0, 0.5, 0.1), f_color);
+	FragColor = vec4(f_color >= 1.0 ? vec3(1.0) : (f_color > 0.0 ? dying : vec3(0.0)), 1.0);
 }
\ No newline at end of file
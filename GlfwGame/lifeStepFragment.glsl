@@ -0,0 +1,39 @@
+#version 330 core
+
+// one generation: every fragment is one cell of the grid, read from the last generation in u_cells
+
+out vec4 FragColor;
+
+uniform sampler2D u_cells; // one byte per cell, 0 dead, 1 alive, 2.. dying
+uniform ivec2 u_size;
+uniform int u_boundary; // 0 dead, 1 torus, 2 mirror, like LifeGrid::Boundary
+uniform int u_birth; // bit n set: born with n live neighbors
+uniform int u_survive;
+uniform int u_states; // more than 2 for Generations rules
+
+int state_at(ivec2 p)
+{
+	if (any(lessThan(p, ivec2(0))) || any(greaterThanEqual(p, u_size))) {
+		if (u_boundary == 0) return 0;
+		p = u_boundary == 1 ? (p + u_size) % u_size : clamp(p, ivec2(0), u_size - 1);
+	}
+	return int(texelFetch(u_cells, p, 0).r * 255.0 + 0.5);
+}
+
+void main()
+{
+	ivec2 p = ivec2(gl_FragCoord.xy);
+	int neighbors = 0;
+	for (int dy = -1; dy <= 1; ++dy) {
+		for (int dx = -1; dx <= 1; ++dx) {
+			if ((dx != 0 || dy != 0) && state_at(p + ivec2(dx, dy)) == 1) ++neighbors;
+		}
+	}
+
+	int state = state_at(p);
+	int next;
+	if (state == 0) next = (u_birth >> neighbors) & 1;
+	else if (state == 1) next = ((u_survive >> neighbors) & 1) != 0 ? 1 : (u_states > 2 ? 2 : 0);
+	else next = state + 1 < u_states ? state + 1 : 0; // dying cells only get older
+	FragColor = vec4(float(next) / 255.0, 0.0, 0.0, 1.0);
+}
\ No newline at end of file
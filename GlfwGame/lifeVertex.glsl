@@ -7,6 +7,9 @@ in int gl_InstanceID;
 uniform vec2 u_offset;
 uniform float u_quad_length;
 uniform int u_m_SIZE;
+uniform bool u_from_texture; // the states are in u_cells (stepped on the gpu), a_color isn't used
+uniform sampler2D u_cells;
+uniform int u_states;
 
 out float f_color;
 
@@ -16,4 +19,9 @@ void main()
 	vec2 pos = u_offset + u_quad_length * (a_Position + pos_instance);
 	gl_Position = vec4(pos.x, pos.y, 0.0, 1.0);
 	f_color = a_color;
+	if (u_from_texture) { // same shades as the cpu makes them
+		int state = int(texelFetch(u_cells, ivec2(pos_instance), 0).r * 255.0 + 0.5);
+		int oldest = u_states - 2;
+		f_color = state == 1 ? 1.0 : (state == 0 ? 0.0 : float(1 + 253 * (oldest - state + 2) / oldest) / 255.0);
+	}
 }
\ No newline at end of file
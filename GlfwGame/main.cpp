@@ -1,5 +1,9 @@
+#include "GpuLife.h"
 #include "Layer.h"
 #include "Life.h"
+#include "Macrocell.h"
+#include "Rle.h"
+#include "Snapshot.h"
 #include "TextRenderer.h"
 
 #include <iostream>
@@ -8,11 +12,355 @@
 #include <chrono>
 #include <thread>
 #include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <cstdio>
+#include <memory>
+#include <limits>
 
 #include "stb_image.h"
 
-int main()
+// command line options
+struct Options {
+    int width = 200; // cells in each direction
+    int height = 200;
+    bool size_set = false; // else a pattern gets room around it
+    int threads = 0; // 0 = all cores
+    LifeGrid::Boundary boundary = LifeGrid::Boundary::Dead;
+    Rule rule; // B3/S23
+    bool rule_set = false; // else the rule of the pattern
+    bool gpu = false; // step on the gpu
+    double speed = 60.0; // generations per second, 0 = unlimited
+    int history = 0; // MB for rewinding in the window, 0 = off
+    const char* pattern = nullptr; // RLE file, Macrocell if it ends in .mc, Snapshot for .snap
+    bool headless = false; // no window, just step and print the result
+    uint64_t generations = 1000; // headless
+    const char* save = nullptr; // RLE (or .mc, .snap) file for the last generation, headless
+    uint64_t checkpoint = 0; // headless, also save every that many generations
+    uint64_t seed = 0; // of the random soup without a pattern
+    double density = 0.5; // of live cells in it
+};
+
+static void print_usage()
 {
+    std::cout << "usage: GlfwGame [--size N] [--width N] [--height N] [--threads N] [--boundary dead|torus|mirror] [--rule RULE] [--gpu] [--speed GPS]\n"
+                 "                [--history MB] [--pattern FILE] [--seed N] [--density D] [--headless] [--gens N] [--save FILE] [--checkpoint N]\n"
+                 "  --size N     N x N cells (default 200)\n"
+                 "  --width N    cells in x\n"
+                 "  --height N   cells in y\n"
+                 "  --threads N  threads stepping generations, 0 = all cores (default)\n"
+                 "  --boundary B what is past the edges: dead (default), torus or mirror\n"
+                 "  --rule RULE  Life-like rule in B/S notation, like B36/S23 (default B3/S23),\n"
+                 "               a Generations rule like B2/S/C3\n"
+                 "               or Larger than Life like R5,C0,M1,S34..58,B34..45,NM\n"
+                 "  --gpu        step generations in a fragment shader (P switches while running),\n"
+                 "               with --headless in an invisible window\n"
+                 "  --speed GPS  generations per second from 0.5 up, or max for unlimited (default 60).\n"
+                 "               LEFT and RIGHT change it while running\n"
+                 "  --history MB memory for the last generations (default 0 = off), , and . go through them while paused.\n"
+                 "               keeping them costs a pass over the grid every generation\n"
+                 "  --pattern F  start from the RLE pattern in F, centered. without a size the grid is twice the pattern\n"
+                 "               (at least 200), without --rule the pattern's rule. F.mc is read as Macrocell, the whole\n"
+                 "               tree goes to the HashLife engine (if it can step the rule) and the grid shows the middle.\n"
+                 "               F.snap is a snapshot, with its own size, rule, boundary and generation\n"
+                 "  --seed N     without a pattern, start from the random soup of seed N (default 0), the same on every machine\n"
+                 "  --density D  of live cells in the soup, from 0 to 1 (default 0.5)\n"
+                 "  --headless   no window: step --gens generations (default 1000) and print the speed,\n"
+                 "               the population and the hash of the last generation\n"
+                 "  --save F     with --headless, write the last generation to F as RLE, or as Macrocell if it ends in .mc\n"
+                 "               or as a snapshot for .snap\n"
+                 "  --checkpoint N  with --save, also write it every N generations\n";
+}
+
+// the biggest side of a grid, as big as the biggest pattern RleReader reads
+static constexpr int MAX_SIDE = 1 << 30;
+// the window draws one instance per cell, and glDrawElementsInstanced takes their count as a GLsizei
+static constexpr int64_t MAX_WINDOW_CELLS = std::numeric_limits<int>::max();
+
+static bool check_size(const Options& options)
+{
+    if (options.width < 3 || options.height < 3 || options.width > MAX_SIDE || options.height > MAX_SIDE) {
+        std::cout << "ERROR::ARGUMENT: grid has to be at least 3x3 cells and at most " << MAX_SIDE << " on a side\n";
+        return false;
+    }
+    if (!options.headless && int64_t(options.width) * options.height > MAX_WINDOW_CELLS) {
+        std::cout << "ERROR::ARGUMENT: the window shows at most " << MAX_WINDOW_CELLS << " cells, "
+                  << options.width << "x" << options.height << " is more (--headless has no limit)\n";
+        return false;
+    }
+    return true;
+}
+
+static bool equals_ignore_case(const char* a, const char* b)
+{
+    for (; *a && *b; ++a, ++b) {
+        if (std::tolower((unsigned char)*a) != std::tolower((unsigned char)*b)) return false;
+    }
+    return *a == *b;
+}
+
+// returns false if the arguments don't make sense
+static bool parse_options(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        const int value = has_value ? std::atoi(argv[i + 1]) : 0;
+
+        if (std::strcmp(arg, "--gpu") == 0) { // no value
+            options.gpu = true;
+            continue;
+        }
+        if (std::strcmp(arg, "--headless") == 0) {
+            options.headless = true;
+            continue;
+        }
+        if (std::strcmp(arg, "--size") == 0 && has_value) {
+            options.width = options.height = value;
+            options.size_set = true;
+        }
+        else if (std::strcmp(arg, "--width") == 0 && has_value) {
+            options.width = value;
+            options.size_set = true;
+        }
+        else if (std::strcmp(arg, "--height") == 0 && has_value) {
+            options.height = value;
+            options.size_set = true;
+        }
+        else if (std::strcmp(arg, "--pattern") == 0 && has_value) {
+            options.pattern = argv[i + 1];
+        }
+        else if (std::strcmp(arg, "--save") == 0 && has_value) {
+            options.save = argv[i + 1];
+        }
+        else if ((std::strcmp(arg, "--gens") == 0 || std::strcmp(arg, "--checkpoint") == 0) && has_value) {
+            char* end;
+            (arg[2] == 'g' ? options.generations : options.checkpoint) = std::strtoull(argv[i + 1], &end, 10);
+            if (*end || argv[i + 1][0] == '-') {
+                std::cout << "ERROR::ARGUMENT: not a number of generations " << argv[i + 1] << "\n";
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--seed") == 0 && has_value) {
+            char* end;
+            options.seed = std::strtoull(argv[i + 1], &end, 10);
+            if (*end || argv[i + 1][0] == '-') {
+                std::cout << "ERROR::ARGUMENT: not a seed " << argv[i + 1] << "\n";
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--density") == 0 && has_value) {
+            char* end;
+            options.density = std::strtod(argv[i + 1], &end);
+            if (*end || !(options.density >= 0.0 && options.density <= 1.0)) {
+                std::cout << "ERROR::ARGUMENT: density is from 0 to 1\n";
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--threads") == 0 && has_value) {
+            options.threads = value;
+        }
+        else if (std::strcmp(arg, "--boundary") == 0 && has_value) {
+            int b = 0;
+            while (b < (int)LifeGrid::Boundary::COUNT && !equals_ignore_case(argv[i + 1], LifeGrid::boundary_name((LifeGrid::Boundary)b))) {
+                ++b;
+            }
+            if (b == (int)LifeGrid::Boundary::COUNT) {
+                std::cout << "ERROR::ARGUMENT: unknown boundary " << argv[i + 1] << "\n";
+                return false;
+            }
+            options.boundary = (LifeGrid::Boundary)b;
+        }
+        else if (std::strcmp(arg, "--speed") == 0 && has_value) {
+            char* end = nullptr;
+            options.speed = equals_ignore_case(argv[i + 1], "max") ? 0.0 : std::strtod(argv[i + 1], &end);
+            if (end && (*end || !(options.speed >= 0.5))) {
+                std::cout << "ERROR::ARGUMENT: speed is 0.5 generations per second or more, or max\n";
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--history") == 0 && has_value) {
+            options.history = value;
+            if (value < 0) {
+                std::cout << "ERROR::ARGUMENT: history can't be negative\n";
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--rule") == 0 && has_value) {
+            if (!Rule::parse(argv[i + 1], options.rule)) {
+                std::cout << "ERROR::ARGUMENT: not a rule " << argv[i + 1] << "\n";
+                return false;
+            }
+            options.rule_set = true;
+        }
+        else {
+            std::cout << "ERROR::ARGUMENT: " << arg << "\n";
+            return false;
+        }
+        ++i; // skip the value
+    }
+    if (!check_size(options)) {
+        return false;
+    }
+    if (options.threads < 0) {
+        std::cout << "ERROR::ARGUMENT: threads can't be negative\n";
+        return false;
+    }
+    return true;
+}
+
+static bool has_extension(const char* path, const char* extension)
+{
+    const size_t length = std::strlen(path), extension_length = std::strlen(extension);
+    return length >= extension_length && equals_ignore_case(path + length - extension_length, extension);
+}
+
+// in the format of the extension: .mc, .snap or else RLE
+static bool save(const char* path, Universe& universe)
+{
+    if (has_extension(path, ".mc")) return write_macrocell(path, universe);
+    if (has_extension(path, ".snap")) return write_snapshot(path, universe);
+    return write_rle(path, universe.grid(), universe.rule());
+}
+
+// the size and rule the pattern asks for, where the options don't say. returns false if the size is no good
+static bool fit_pattern(const RleReader::Header& header, Options& options)
+{
+    if (!options.size_set) {
+        // twice a pattern of up to 2^30 cells doesn't fit in an int
+        options.width = (int)std::min<int64_t>(std::max<int64_t>(options.width, 2 * int64_t(header.width)), MAX_SIDE);
+        options.height = (int)std::min<int64_t>(std::max<int64_t>(options.height, 2 * int64_t(header.height)), MAX_SIDE);
+    }
+    if (!options.rule_set && header.has_rule) {
+        options.rule = header.rule;
+    }
+    return check_size(options);
+}
+
+// generations queued up on the gpu at a time
+static constexpr int GPU_STEP_GENERATIONS = 1 << 16;
+
+// no window, for scripts on machines without a display. opengl only with --gpu, with an invisible window
+static int run_headless(const Options& options, RleReader* pattern, MacrocellReader* macrocell, Snapshot* snapshot)
+{
+    Universe universe(options.width, options.height, options.threads);
+    universe.set_boundary(options.boundary);
+    universe.set_rule(options.rule);
+    if (pattern) {
+        const RleReader::Header& header = pattern->header();
+        const int left = (options.width - header.width) / 2;
+        const int top = (options.height - header.height) / 2 + header.height - 1;
+        if (!universe.load_cells([&](LifeGrid& grid) { return pattern->read_cells(grid, left, top); })) return 1;
+    }
+    else if (macrocell) {
+        if (!universe.load_tree([&](HashLife& tree) { return macrocell->read_nodes(tree); })) return 1;
+    }
+    else if (snapshot) {
+        if (!snapshot->load(universe)) return 1;
+        snapshot->close(); // only the universe has the file mapped, so --save can replace it
+    }
+    else {
+        universe.randomize(options.seed, options.density);
+    }
+
+    // the cells come back to the universe for saving and for the result
+    Layer layer;
+    std::unique_ptr<GpuLife> gpu;
+    if (options.gpu) {
+        if (!GpuLife::supports_rule(universe.rule())) {
+            std::cout << "ERROR::GPU: can't step " << universe.rule().to_string() << "\n";
+            return 1;
+        }
+        if (layer.start_offscreen()) return 1;
+        gpu.reset(new GpuLife(options.width, options.height));
+        gpu->load(universe);
+    }
+    auto step = [&](uint64_t generations) {
+        if (!gpu) {
+            universe.step(generations);
+            return;
+        }
+        for (uint64_t left = generations; left > 0;) {
+            const int pass = (int)std::min<uint64_t>(left, GPU_STEP_GENERATIONS);
+            gpu->step(pass);
+            left -= pass;
+        }
+    };
+    auto finish = [&](int result) {
+        gpu.reset(); // while the context is still there
+        if (options.gpu) layer.clean_up();
+        return result;
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t first = universe.generation();
+    for (uint64_t left = options.generations; left > 0;) {
+        const uint64_t generations = options.checkpoint && options.save ? std::min(left, options.checkpoint) : left;
+        step(generations);
+        left -= generations;
+        if (left > 0) {
+            if (gpu) gpu->store(universe);
+            if (!save(options.save, universe)) return finish(1);
+        }
+    }
+    if (gpu) {
+        gpu->store(universe); // waits for the gpu to get there
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)universe.state_hash());
+    const LifeStats& stats = universe.stats();
+    std::cout << "size: " << options.width << "x" << options.height << ", rule: " << universe.rule().to_string() << '\n'
+              << "generations: " << universe.generation() << '\n'
+              << "seconds: " << seconds << '\n'
+              << "generations/sec: " << (seconds > 0.0 ? (universe.generation() - first) / seconds : 0.0) << '\n'
+              << "population: " << stats.population << '\n'
+              << "births: " << stats.births << ", deaths: " << stats.deaths << '\n';
+    if (!stats.empty()) {
+        std::cout << "box: " << stats.min_x << "," << stats.min_y << " to " << stats.max_x << "," << stats.max_y << '\n';
+    }
+    std::cout << "hash: " << hash << '\n';
+    if (options.save && !save(options.save, universe)) return finish(1);
+    return finish(0);
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    // a Macrocell pattern can be any size, it keeps the grid of the options. a snapshot is of one size
+    RleReader pattern;
+    MacrocellReader macrocell;
+    Snapshot snapshot;
+    const bool from_macrocell = options.pattern && has_extension(options.pattern, ".mc");
+    const bool from_snapshot = options.pattern && has_extension(options.pattern, ".snap");
+    const bool from_rle = options.pattern && !from_macrocell && !from_snapshot;
+    if (from_rle) {
+        if (!pattern.open(options.pattern)) return 1;
+        if (!fit_pattern(pattern.header(), options)) return 1;
+    }
+    if (from_macrocell) {
+        if (!macrocell.open(options.pattern)) return 1;
+        if (!options.rule_set && macrocell.header().has_rule) options.rule = macrocell.header().rule;
+    }
+    if (from_snapshot) {
+        if (!snapshot.open(options.pattern)) return 1;
+        options.width = snapshot.header().width;
+        options.height = snapshot.header().height;
+    }
+    if (options.headless) {
+        return run_headless(options, from_rle ? &pattern : nullptr, from_macrocell ? &macrocell : nullptr,
+                            from_snapshot ? &snapshot : nullptr);
+    }
+
     Layer layer; // setup code
     {
         int result = layer.start();
@@ -189,7 +537,15 @@ int main()
     int time_uniform = glGetUniformLocation(shaderProgram, "time");
     int offset_uniform = glGetUniformLocation(shaderProgram, "offset");
 
-    Life life;
+    Life life(options.width, options.height, options.boundary, options.rule, options.threads);
+    if (from_rle && !life.load_pattern(pattern)) return 1;
+    if (from_macrocell && !life.load_macrocell(macrocell)) return 1;
+    if (from_snapshot && !life.load_snapshot(snapshot)) return 1;
+    snapshot.close(); // only the universe has the file mapped, so K can replace it
+    if (!options.pattern) life.randomize(options.seed, options.density);
+    life.set_speed(options.speed);
+    life.set_history(size_t(options.history) << 20);
+    if (options.gpu && !life.set_gpu(true)) return 1;
     float x = 0.f;
 
     // game of life
@@ -0,0 +1,66 @@
+// Steps the same soup with GpuLife and with Universe, for every boundary and for a Generations rule,
+// and checks that every cell has the same state. Needs an opengl 3.3 context, Mesa's llvmpipe does.
+// Build from GlfwGame with all the .cpp files but main.cpp, Life.cpp, Simulation.cpp and TextRenderer.cpp, and glad.c:
+// g++ -std=c++14 -I. tests/GpuLifeTest.cpp GpuLife.cpp Layer.cpp Universe.cpp ... glad.c -lglfw -ldl -pthread
+// and run it from GlfwGame, for the shaders
+#include "GpuLife.h"
+#include "Layer.h"
+#include "Universe.h"
+
+#include <iostream>
+#include <vector>
+
+static bool same_states(const char* rule_string, LifeGrid::Boundary boundary)
+{
+    // not a multiple of 64 wide, so the last word of a row has cells past the edge
+    const int width = 301, height = 177;
+    Rule rule;
+    if (!Rule::parse(rule_string, rule)) {
+        std::cout << "ERROR::TEST: can't parse " << rule_string << "\n";
+        return false;
+    }
+
+    Universe universe(width, height);
+    universe.set_boundary(boundary);
+    universe.set_rule(rule);
+    universe.randomize(1, 0.3);
+    GpuLife gpu(width, height);
+    gpu.load(universe);
+
+    std::vector<uint8_t> states;
+    for (int generation = 1; generation <= 200; ++generation) {
+        universe.step();
+        gpu.step();
+        gpu.read(states);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                if (states[size_t(y) * width + x] != universe.state(x, y)) {
+                    std::cout << "ERROR::TEST: " << rule_string << ", " << LifeGrid::boundary_name(boundary) << ": cell " << x << "," << y
+                              << " is " << (int)states[size_t(y) * width + x] << " on the gpu and " << universe.state(x, y)
+                              << " on the cpu in generation " << generation << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    Layer layer;
+    if (layer.start_offscreen()) return 1;
+
+    bool ok = true;
+    const char* rules[] = { "B3/S23", "B2/S/C3" };
+    const LifeGrid::Boundary boundaries[] = { LifeGrid::Boundary::Dead, LifeGrid::Boundary::Torus, LifeGrid::Boundary::Mirror };
+    for (const char* rule : rules) {
+        for (LifeGrid::Boundary boundary : boundaries) {
+            ok = same_states(rule, boundary) && ok;
+        }
+    }
+    layer.clean_up();
+    if (!ok) return 1;
+    std::cout << "gpu life: the same as the universe for every boundary\n";
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Loads grids with cells along every edge into HashLife and stores them back, which has to give the same cells.
+// Then steps an R-pentomino with HashLife twice, once with a node limit small enough to garbage collect
+// every few generations and once without, and checks that both have the same cells every generation.
+// Build from GlfwGame with: g++ -std=c++14 -I. tests/HashLifeGcTest.cpp HashLife.cpp LifeGrid.cpp Rule.cpp
+#include "HashLife.h"
+#include "LifeGrid.h"
+
+#include <iostream>
+
+static bool same_cells(const LifeGrid& a, const LifeGrid& b)
+{
+    for (int i = 0; i < a.height(); ++i) {
+        for (int w = 0; w < a.words_per_row(); ++w) {
+            if (a.row(i)[w] != b.row(i)[w]) return false;
+        }
+    }
+    return true;
+}
+
+// the tree is bigger than the grid and starts above and left of it, so its nodes cross every edge
+static bool round_trip(int width, int height)
+{
+    LifeGrid grid(width, height);
+    for (int x = 0; x < width; x += 3) {
+        grid.set(x, 0, true);
+        grid.set(x, 1, (x / 3) % 2 == 0);
+        grid.set(x, height - 1, true);
+    }
+    for (int y = 0; y < height; y += 2) {
+        for (int x = width - 64; x < width; x += 5 + y % 3) {
+            grid.set(x, y, true);
+        }
+        grid.set(0, y, true);
+    }
+
+    HashLife tree;
+    tree.load(grid);
+    LifeGrid back(width, height);
+    tree.store(back);
+    if (tree.population() != grid.population() || !same_cells(grid, back)) {
+        std::cout << "ERROR::TEST: a " << width << "x" << height << " grid comes back different from hashlife\n";
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    if (!round_trip(300, 300) || !round_trip(320, 130) || !round_trip(64, 3) || !round_trip(1000, 70)) return 1;
+
+    const int size = 512;
+    LifeGrid start(size, size);
+    const int x = size / 2, y = size / 2;
+    start.set(x + 1, y, true);
+    start.set(x + 2, y, true);
+    start.set(x, y + 1, true);
+    start.set(x + 1, y + 1, true);
+    start.set(x + 1, y + 2, true);
+
+    HashLife collected, kept;
+    collected.set_max_nodes(2000);
+    collected.load(start);
+    kept.load(start);
+
+    LifeGrid a(size, size), b(size, size);
+    int collections = 0;
+    for (int generation = 1; generation <= 1200; ++generation) {
+        const size_t nodes = collected.node_count();
+        collected.step();
+        kept.step();
+        if (collected.node_count() < nodes) ++collections;
+
+        collected.store(a);
+        kept.store(b);
+        if (collected.population() != kept.population() || !same_cells(a, b)) {
+            std::cout << "ERROR::TEST: cells differ after garbage collection at generation " << generation << '\n';
+            return 1;
+        }
+    }
+    if (collections == 0) {
+        std::cout << "ERROR::TEST: never garbage collected\n";
+        return 1;
+    }
+    std::cout << "hashlife gc: " << collections << " collections, population " << collected.population() << '\n';
+    return 0;
+}
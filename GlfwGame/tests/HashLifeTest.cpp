@@ -0,0 +1,73 @@
+// Steps a random soup with HashLife, 4 generations a step, and with the Dense engine of a Universe and checks
+// that they have the same cells after every step. The soup fills its grid up to the edges, and the universe
+// has it in the middle with enough room around it that nothing reaches its dead edges.
+// Build from GlfwGame with the simulation sources:
+// g++ -std=c++14 -I. tests/HashLifeTest.cpp Universe.cpp ActiveTiles.cpp ChangeList.cpp CycleDetector.cpp Generations.cpp
+//     History.cpp LifeGrid.cpp LifeKernel*.cpp LifeStats.cpp Random.cpp Rule.cpp TemporalBlocking.cpp ThreadPool.cpp
+//     HashLife.cpp SparseLife.cpp LookupLife.cpp LargerThanLife.cpp -pthread
+#include "HashLife.h"
+#include "LifeGrid.h"
+#include "Random.h"
+#include "Universe.h"
+
+#include <iostream>
+
+static bool same_as_dense(const char* rule_string, uint64_t seed)
+{
+    const int width = 150, height = 100; // not a multiple of 64 wide
+    const int exponent = 2, steps = 25;
+    const int margin = (steps << exponent) + 8; // further than anything gets in that many generations
+    Rule rule;
+    Rule::parse(rule_string, rule);
+
+    LifeGrid soup(width, height);
+    Random(seed).fill(soup, 0.35);
+    HashLife tree;
+    tree.set_rule(rule);
+    tree.set_step_exponent(exponent);
+    tree.load(soup);
+
+    // cell (x, y) of the soup is (x + margin, y + margin) in the universe
+    Universe universe(width + 2 * margin, height + 2 * margin);
+    universe.set_rule(rule);
+    universe.load_cells([&](LifeGrid& grid) {
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                if (soup.get(x, y)) grid.set(x + margin, y + margin, true);
+            }
+        }
+        return true;
+    });
+
+    for (int step = 1; step <= steps; ++step) {
+        tree.step();
+        universe.step(uint64_t(1) << exponent);
+        if (tree.population() != universe.stats().population) {
+            std::cout << "ERROR::TEST: " << rule_string << ", seed " << seed << ": population " << tree.population()
+                      << " with hashlife and " << universe.stats().population << " with dense after step " << step << "\n";
+            return false;
+        }
+        for (int y = 0; y < universe.height(); ++y) {
+            for (int x = 0; x < universe.width(); ++x) {
+                if (tree.get(x - margin, y - margin) != universe.get(x, y)) {
+                    std::cout << "ERROR::TEST: " << rule_string << ", seed " << seed << ": cell " << x - margin << "," << y - margin
+                              << " differs after step " << step << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    bool ok = true;
+    for (uint64_t seed = 1; seed <= 3; ++seed) {
+        ok = same_as_dense("B3/S23", seed) && ok;
+    }
+    ok = same_as_dense("B36/S23", 4) && ok;
+    if (!ok) return 1;
+    std::cout << "hashlife: the same as dense\n";
+    return 0;
+}
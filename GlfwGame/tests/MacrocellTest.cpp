@@ -0,0 +1,132 @@
+// Writes a stepped soup as Macrocell, reads it back into another universe, which moves to HashLife, and steps both,
+// which have to stay the same. Then the other way round, from the HashLife engine. The soup is in the middle
+// with room around it, so the dead edges of the Dense universe don't matter.
+// Then a file cut off in a line, one with a child that isn't there and one without [M2] have to be refused
+// without changing the universe or its tree.
+// Build from GlfwGame with the simulation sources:
+// g++ -std=c++14 -I. tests/MacrocellTest.cpp Macrocell.cpp Universe.cpp ActiveTiles.cpp ChangeList.cpp CycleDetector.cpp
+//     Generations.cpp History.cpp LifeGrid.cpp LifeKernel*.cpp LifeStats.cpp Random.cpp Rule.cpp TemporalBlocking.cpp
+//     ThreadPool.cpp HashLife.cpp SparseLife.cpp LookupLife.cpp LargerThanLife.cpp -pthread
+#include "Macrocell.h"
+#include "Random.h"
+#include "Universe.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+static const char* PATH = "macrocell_test.mc";
+static const char* BROKEN_PATH = "macrocell_test_broken.mc";
+
+static bool load(const char* path, Universe& universe)
+{
+    MacrocellReader reader;
+    return reader.open(path) && universe.load_tree([&](HashLife& tree) { return reader.read_nodes(tree); });
+}
+
+static bool same_cells(const Universe& a, const Universe& b)
+{
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            if (a.get(x, y) != b.get(x, y)) return false;
+        }
+    }
+    return a.stats().population == b.stats().population;
+}
+
+// loading path into universe has to fail and leave it and its tree as they were
+static bool refused(const char* path, Universe& universe, const char* what)
+{
+    const uint64_t hash = universe.state_hash(), population = universe.hashlife().population();
+    if (load(path, universe)) {
+        std::cout << "ERROR::TEST: loaded " << what << "\n";
+        return false;
+    }
+    if (universe.state_hash() != hash || universe.hashlife().population() != population) {
+        std::cout << "ERROR::TEST: " << what << " changed the universe\n";
+        return false;
+    }
+    return true;
+}
+
+static bool round_trip(const char* rule_string, uint64_t seed)
+{
+    const int width = 400, height = 300, soup_width = 150, soup_height = 100;
+    Rule rule;
+    Rule::parse(rule_string, rule);
+    LifeGrid soup(soup_width, soup_height);
+    Random(seed).fill(soup, 0.35);
+    Universe saved(width, height);
+    saved.set_rule(rule);
+    saved.load_cells([&](LifeGrid& grid) {
+        for (int y = 0; y < soup_height; ++y) {
+            for (int x = 0; x < soup_width; ++x) {
+                if (soup.get(x, y)) grid.set(x + (width - soup_width) / 2, y + (height - soup_height) / 2, true);
+            }
+        }
+        return true;
+    });
+    saved.step(20);
+    if (!write_macrocell(PATH, saved)) return false;
+
+    Universe loaded(width, height);
+    loaded.set_rule(rule);
+    if (!load(PATH, loaded) || loaded.engine() != Universe::Engine::HashLife) {
+        std::cout << "ERROR::TEST: can't load " << rule_string << " into HashLife\n";
+        return false;
+    }
+    if (!same_cells(saved, loaded) || loaded.hashlife().population() != saved.stats().population) {
+        std::cout << "ERROR::TEST: " << rule_string << ", seed " << seed << " isn't the same after reading\n";
+        return false;
+    }
+    saved.step(30);
+    loaded.step(30);
+    if (!same_cells(saved, loaded)) {
+        std::cout << "ERROR::TEST: " << rule_string << ", seed " << seed << " steps differently after reading\n";
+        return false;
+    }
+
+    // and the tree of the HashLife engine back
+    if (!write_macrocell(PATH, loaded)) return false;
+    Universe reloaded(width, height);
+    reloaded.set_rule(rule);
+    if (!load(PATH, reloaded) || !same_cells(loaded, reloaded)) {
+        std::cout << "ERROR::TEST: " << rule_string << ", seed " << seed << " isn't the same after writing the tree\n";
+        return false;
+    }
+
+    // the file cut off after the level and a child of the root, the root with a child that isn't there, no [M2]
+    std::ifstream file(PATH, std::ios::binary);
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const size_t root = text.rfind('\n', text.size() - 2) + 1;
+    const std::string root_level = text.substr(root, text.find(' ', root) - root);
+    std::ofstream(BROKEN_PATH, std::ios::binary) << text.substr(0, text.find(' ', text.find(' ', root) + 1));
+    bool ok = refused(BROKEN_PATH, loaded, "a cut off macrocell");
+    std::ofstream(BROKEN_PATH, std::ios::binary) << text.substr(0, root) << root_level << " 99999999 0 0 0\n";
+    ok = refused(BROKEN_PATH, loaded, "a macrocell with a bad child") && ok;
+    std::ofstream(BROKEN_PATH, std::ios::binary) << text.substr(text.find('\n') + 1);
+    ok = refused(BROKEN_PATH, loaded, "a macrocell without [M2]") && ok;
+
+    // the tree is still the one that was loaded
+    saved.step(10);
+    loaded.step(10);
+    if (!same_cells(saved, loaded)) {
+        std::cout << "ERROR::TEST: " << rule_string << ", seed " << seed << " steps differently after the broken files\n";
+        return false;
+    }
+    return ok;
+}
+
+int main()
+{
+    bool ok = round_trip("B3/S23", 1);
+    ok = round_trip("B3/S23", 2) && ok;
+    ok = round_trip("B36/S23", 3) && ok;
+    std::remove(PATH);
+    std::remove(BROKEN_PATH);
+    if (!ok) return 1;
+    std::cout << "macrocell: the same after writing, reading and stepping\n";
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Writes stepped soups as RLE, reads them back into another universe where they were and steps both,
+// which have to stay the same. The big soup is several blocks of the reader, so runs are split between blocks.
+// Then a cut off file and a broken header have to be refused without changing the universe.
+// Build from GlfwGame with the simulation sources:
+// g++ -std=c++14 -I. tests/RleTest.cpp Rle.cpp Universe.cpp ActiveTiles.cpp ChangeList.cpp CycleDetector.cpp
+//     Generations.cpp History.cpp LifeGrid.cpp LifeKernel*.cpp LifeStats.cpp Random.cpp Rule.cpp TemporalBlocking.cpp
+//     ThreadPool.cpp HashLife.cpp SparseLife.cpp LookupLife.cpp LargerThanLife.cpp -pthread
+#include "Rle.h"
+#include "Universe.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+static const char* PATH = "rle_test.rle";
+static const char* BROKEN_PATH = "rle_test_broken.rle";
+
+static bool load(const char* path, Universe& universe, int left, int top)
+{
+    RleReader reader;
+    return reader.open(path) && universe.load_cells([&](LifeGrid& grid) { return reader.read_cells(grid, left, top); });
+}
+
+// loading path into universe has to fail and leave it as it was
+static bool refused(const char* path, Universe& universe, const char* what)
+{
+    const uint64_t hash = universe.state_hash(), population = universe.stats().population;
+    if (load(path, universe, 0, universe.height() - 1)) {
+        std::cout << "ERROR::TEST: loaded " << what << "\n";
+        return false;
+    }
+    if (universe.state_hash() != hash || universe.stats().population != population) {
+        std::cout << "ERROR::TEST: " << what << " changed the universe\n";
+        return false;
+    }
+    return true;
+}
+
+static bool round_trip(const char* rule_string, int width, int height)
+{
+    Rule rule;
+    Rule::parse(rule_string, rule);
+    Universe saved(width, height);
+    saved.set_rule(rule);
+    saved.randomize(width, 0.4);
+    saved.step(20);
+    if (!write_rle(PATH, saved.grid(), saved.rule())) return false;
+
+    RleReader reader;
+    if (!reader.open(PATH)) return false;
+    const LifeStats& box = saved.stats();
+    if (!reader.header().has_rule || !(reader.header().rule == rule)
+        || reader.header().width != box.max_x - box.min_x + 1 || reader.header().height != box.max_y - box.min_y + 1) {
+        std::cout << "ERROR::TEST: the header of " << rule_string << " isn't the rule and box of the cells\n";
+        return false;
+    }
+
+    // the top row of the file is the highest y
+    Universe loaded(width, height);
+    loaded.set_rule(rule);
+    if (!loaded.load_cells([&](LifeGrid& grid) { return reader.read_cells(grid, box.min_x, box.max_y); })) return false;
+    if (loaded.state_hash() != saved.state_hash()) {
+        std::cout << "ERROR::TEST: " << rule_string << ", " << width << "x" << height << " isn't the same after reading\n";
+        return false;
+    }
+    saved.step(30);
+    loaded.step(30);
+    if (loaded.state_hash() != saved.state_hash()) {
+        std::cout << "ERROR::TEST: " << rule_string << " steps differently after reading\n";
+        return false;
+    }
+
+    // the file cut off in the middle, and a header with a size that can't be
+    std::ifstream file(PATH, std::ios::binary);
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::ofstream(BROKEN_PATH, std::ios::binary).write(bytes.data(), bytes.size() / 2);
+    bool ok = refused(BROKEN_PATH, loaded, "a cut off pattern");
+    std::ofstream(BROKEN_PATH, std::ios::binary) << "x = -3, y = 2, rule = B3/S23\nbo$2o!\n";
+    ok = refused(BROKEN_PATH, loaded, "a pattern with a broken header") && ok;
+    return ok;
+}
+
+int main()
+{
+    bool ok = round_trip("B3/S23", 301, 200);
+    ok = round_trip("B36/S23", 2000, 1500) && ok;
+    std::remove(PATH);
+    std::remove(BROKEN_PATH);
+    if (!ok) return 1;
+    std::cout << "rle: the same after writing, reading and stepping\n";
+    return 0;
+}
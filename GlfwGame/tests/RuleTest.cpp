@@ -0,0 +1,70 @@
+// Parses rules, writes them with to_string and parses that again, which has to give the same rule and the same text.
+// The Larger than Life ones are written with M0 and M1, with ranges past the counts there are and empty ranges.
+// Build from GlfwGame with:
+// g++ -std=c++14 -I. tests/RuleTest.cpp Rule.cpp
+#include "Rule.h"
+
+#include <iostream>
+
+static bool round_trip(const char* text)
+{
+    Rule rule, again;
+    if (!Rule::parse(text, rule)) {
+        std::cout << "ERROR::TEST: can't parse " << text << "\n";
+        return false;
+    }
+    const std::string written = rule.to_string();
+    if (!Rule::parse(written.c_str(), again) || again != rule || again.to_string() != written) {
+        std::cout << "ERROR::TEST: " << text << " is written as " << written << ", which isn't the same rule\n";
+        return false;
+    }
+    return true;
+}
+
+// the rule of text decides next like next_of
+template <typename Next>
+static bool steps_like(const char* text, int max_count, Next next_of)
+{
+    Rule rule;
+    Rule::parse(text, rule);
+    for (int alive = 0; alive <= 1; ++alive) {
+        for (int n = 0; n <= max_count; ++n) {
+            if (rule.next(alive != 0, n) != next_of(alive != 0, n)) {
+                std::cout << "ERROR::TEST: " << text << " is wrong for " << (alive ? "a live" : "a dead") << " cell with " << n << " neighbors\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    const char* rules[] = {
+        "B3/S23", "B36/S23", "b3s23", "23/36", "B/S", "B2/S/C3", "B2/S345/C4", "B012345678/S012345678",
+        "R5,C0,M1,S34..58,B34..45,NM", "R5,C0,M0,S34..58,B34..45,NM", "R5,C3,M1,S34..58,B34..45,NM",
+        "R2,C0,M1,S0..0,B3..3,NM", "R2,C0,M0,S0..0,B0..0,NM", "R2,C0,M1,S0..24,B1..24,NM", "R2,C0,M1,S1..25,B1..99,NM",
+        "R3,C0,M0,S10..5,B7..2,NM", "R10,C16,M1,S1..441,B1..440,NM", "R4", "R4,M1", "R7,B20..30", "R1,C0,M1,S3..4,B3..3,NM",
+    };
+    bool ok = true;
+    for (const char* rule : rules) {
+        ok = round_trip(rule) && ok;
+    }
+
+    // with M1 the cell counts itself when it survives
+    ok = steps_like("R2,C0,M1,S0..0,B3..3,NM", 24, [](bool alive, int n) { return !alive && n == 3; }) && ok;
+    ok = steps_like("R2,C0,M1,S1..1,B3..3,NM", 24, [](bool alive, int n) { return alive ? n == 0 : n == 3; }) && ok;
+    ok = steps_like("R2,C0,M1,S25..30,B30..40,NM", 24, [](bool alive, int n) { return alive && n == 24; }) && ok;
+    ok = steps_like("R2", 24, [](bool, int) { return false; }) && ok;
+    ok = steps_like("R1,C0,M1,S3..4,B3..3,NM", 8, [](bool alive, int n) { return n == 3 || (alive && n == 2); }) && ok;
+    Rule conway, written_ltl;
+    Rule::parse("B3/S23", conway);
+    Rule::parse("R1,C0,M1,S3..4,B3..3,NM", written_ltl);
+    if (conway != written_ltl) {
+        std::cout << "ERROR::TEST: R1,C0,M1,S3..4,B3..3,NM isn't B3/S23\n";
+        ok = false;
+    }
+    if (!ok) return 1;
+    std::cout << "rules: the same after to_string and parse\n";
+    return 0;
+}
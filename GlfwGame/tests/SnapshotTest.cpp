@@ -0,0 +1,117 @@
+// Saves a universe as a snapshot, maps it into another one and steps both, which have to stay the same.
+// Then a cut off file, a broken header and a snapshot of the wrong size have to be refused
+// without changing the universe they were loaded into.
+// Build from GlfwGame with the simulation sources:
+// g++ -std=c++14 -I. tests/SnapshotTest.cpp Snapshot.cpp Universe.cpp ActiveTiles.cpp ChangeList.cpp CycleDetector.cpp
+//     Generations.cpp History.cpp LifeGrid.cpp LifeKernel*.cpp LifeStats.cpp Random.cpp Rule.cpp TemporalBlocking.cpp
+//     ThreadPool.cpp HashLife.cpp SparseLife.cpp LookupLife.cpp LargerThanLife.cpp -pthread
+#include "Snapshot.h"
+#include "Universe.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+static const char* PATH = "snapshot_test.snap";
+static const char* BROKEN_PATH = "snapshot_test_broken.snap";
+
+static bool same(const Universe& a, const Universe& b)
+{
+    return a.state_hash() == b.state_hash() && a.generation() == b.generation() && a.rule() == b.rule()
+        && a.boundary() == b.boundary() && a.stats().population == b.stats().population
+        && a.stats().min_x == b.stats().min_x && a.stats().max_y == b.stats().max_y;
+}
+
+static std::vector<char> read_file(const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void write_file(const char* path, const std::vector<char>& bytes)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(bytes.data(), bytes.size());
+}
+
+// loading path into universe has to fail and leave it as it was
+static bool refused(const char* path, Universe& universe, const char* what)
+{
+    const uint64_t hash = universe.state_hash(), generation = universe.generation();
+    const Rule rule = universe.rule();
+    const LifeGrid::Boundary boundary = universe.boundary();
+    Snapshot snapshot;
+    if (snapshot.open(path) && snapshot.load(universe)) {
+        std::cout << "ERROR::TEST: loaded " << what << "\n";
+        return false;
+    }
+    if (universe.state_hash() != hash || universe.generation() != generation || !(universe.rule() == rule) || universe.boundary() != boundary) {
+        std::cout << "ERROR::TEST: " << what << " changed the universe\n";
+        return false;
+    }
+    return true;
+}
+
+static bool round_trip(const char* rule_string, LifeGrid::Boundary boundary)
+{
+    Rule rule;
+    Rule::parse(rule_string, rule);
+    Universe saved(301, 120);
+    saved.set_rule(rule);
+    saved.set_boundary(boundary);
+    saved.randomize(9, 0.4);
+    saved.step(30);
+    if (!write_snapshot(PATH, saved)) return false;
+
+    Universe loaded(301, 120);
+    {
+        Snapshot snapshot;
+        if (!snapshot.open(PATH) || !snapshot.load(loaded)) {
+            std::cout << "ERROR::TEST: can't load the snapshot of " << rule_string << "\n";
+            return false;
+        }
+    }
+    if (!same(saved, loaded)) {
+        std::cout << "ERROR::TEST: " << rule_string << " isn't the same after loading\n";
+        return false;
+    }
+    for (int i = 0; i < 50; ++i) {
+        saved.step();
+        loaded.step();
+    }
+    if (!same(saved, loaded)) {
+        std::cout << "ERROR::TEST: " << rule_string << " steps differently after loading\n";
+        return false;
+    }
+
+    // the saved file, cut off and with a boundary that doesn't exist
+    const std::vector<char> bytes = read_file(PATH);
+    std::vector<char> broken(bytes.begin(), bytes.end() - 100);
+    write_file(BROKEN_PATH, broken);
+    bool ok = refused(BROKEN_PATH, loaded, "a cut off snapshot");
+    broken = bytes;
+    const int32_t boundary_count = (int32_t)LifeGrid::Boundary::COUNT;
+    std::memcpy(broken.data() + offsetof(Snapshot::Header, boundary), &boundary_count, sizeof(boundary_count));
+    write_file(BROKEN_PATH, broken);
+    ok = refused(BROKEN_PATH, loaded, "a snapshot with a broken boundary") && ok;
+    Universe smaller(300, 120);
+    smaller.randomize(2);
+    ok = refused(PATH, smaller, "a snapshot of another size") && ok;
+    return ok;
+}
+
+int main()
+{
+    bool ok = round_trip("B3/S23", LifeGrid::Boundary::Dead);
+    ok = round_trip("B2/S345/C4", LifeGrid::Boundary::Torus) && ok;
+    ok = round_trip("B36/S23", LifeGrid::Boundary::Mirror) && ok;
+    std::remove(PATH);
+    std::remove(BROKEN_PATH);
+    if (!ok) return 1;
+    std::cout << "snapshot: the same after saving, mapping and stepping\n";
+    return 0;
+}